@@ -0,0 +1,278 @@
+/*
+ * Character Scanning: the inner loops of the tokenizer, a block at a time
+ *
+ * This file provides the definitions of the functions declared in
+ * CharScan.h, in scalar, SSE2, and AVX2 versions.
+ *
+ * A vector version loads a block of characters, compares it with each
+ * character of interest at once, and turns the comparisons into a bit
+ * mask with one bit per character; the position of the lowest set bit
+ * is the position of the first match.  Whitespace other than the space
+ * (tab through carriage return, 9 to 13) is tested as one range:
+ * c - 9 is at most 4 (as an unsigned byte) exactly when c is in it.
+ *
+ */
+
+#include <stddef.h>
+
+#include "CharScan.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define HAVE_X86_VECTORS 1
+#include <immintrin.h>
+#else
+#define HAVE_X86_VECTORS 0
+#endif
+
+/* Declarations of the versions, and of the selectors that pick one on first use. */
+static inline const char * spacesScalar (const char * p, const char * end);
+static inline const char * delimiterScalar (const char * p, const char * end);
+static inline const char * commentScalar (const char * p, const char * end);
+static const char * spacesFirst (const char * p, const char * end);
+static const char * delimiterFirst (const char * p, const char * end);
+static const char * commentFirst (const char * p, const char * end);
+
+/* Classification of every character value (see CharScan.h). */
+const unsigned char CHAR_CLASS[256] = {
+        ['\0'] = CHAR_NUL,
+        ['\t'] = CHAR_SPACE, ['\n'] = CHAR_SPACE, ['\v'] = CHAR_SPACE,
+        ['\f'] = CHAR_SPACE, ['\r'] = CHAR_SPACE, [' '] = CHAR_SPACE,
+        [','] = CHAR_PUNCT, [':'] = CHAR_PUNCT, ['('] = CHAR_PUNCT, [')'] = CHAR_PUNCT,
+        ['#'] = CHAR_COMMENT, ['$'] = CHAR_DOLLAR,
+        ['0'] = CHAR_NUMBER, ['1'] = CHAR_NUMBER, ['2'] = CHAR_NUMBER, ['3'] = CHAR_NUMBER,
+        ['4'] = CHAR_NUMBER, ['5'] = CHAR_NUMBER, ['6'] = CHAR_NUMBER, ['7'] = CHAR_NUMBER,
+        ['8'] = CHAR_NUMBER, ['9'] = CHAR_NUMBER, ['-'] = CHAR_NUMBER, ['+'] = CHAR_NUMBER
+};
+
+/* The versions in use (global to this file only). */
+static const char * (*spacesFn) (const char *, const char *) = spacesFirst;
+static const char * (*delimiterFn) (const char *, const char *) = delimiterFirst;
+static const char * (*commentFn) (const char *, const char *) = commentFirst;
+
+const char * scanSpaces (const char * p, const char * end)
+  /* Returns a pointer to the first character that is not whitespace, or end. */
+{
+        return spacesFn (p, end);
+}
+
+const char * scanDelimiter (const char * p, const char * end)
+  /* Returns a pointer to the first delimiter, or end. */
+{
+        return delimiterFn (p, end);
+}
+
+const char * scanComment (const char * p, const char * end)
+  /* Returns a pointer to the first '#', or end. */
+{
+        return commentFn (p, end);
+}
+
+
+/* SCALAR VERSIONS */
+
+static inline const char * spacesScalar (const char * p, const char * end)
+{
+        while ( p < end && (CHAR_CLASS[(unsigned char) *p] & CHAR_SPACE) )
+            p++;
+        return p;
+}
+
+static inline const char * delimiterScalar (const char * p, const char * end)
+{
+        while ( p < end && ! (CHAR_CLASS[(unsigned char) *p] & CHAR_DELIMITER) )
+            p++;
+        return p;
+}
+
+static inline const char * commentScalar (const char * p, const char * end)
+{
+        while ( p < end && *p != '#' )
+            p++;
+        return p;
+}
+
+
+#if HAVE_X86_VECTORS
+
+/* SSE2 VERSIONS (16 characters at a time) */
+
+static inline __m128i spaces16 (__m128i v)
+  /* Returns a mask with 0xff in each byte of v that is whitespace. */
+{
+        __m128i range = _mm_sub_epi8 (v, _mm_set1_epi8 ('\t'));
+
+        return _mm_or_si128 (_mm_cmpeq_epi8 (v, _mm_set1_epi8 (' ')),
+                             _mm_cmpeq_epi8 (_mm_min_epu8 (range, _mm_set1_epi8 ('\r' - '\t')), range));
+}
+
+static inline __m128i delimiters16 (__m128i v)
+  /* Returns a mask with 0xff in each byte of v that is a delimiter. */
+{
+        __m128i punct = _mm_or_si128 (
+                _mm_or_si128 (_mm_cmpeq_epi8 (v, _mm_set1_epi8 (',')),
+                              _mm_cmpeq_epi8 (v, _mm_set1_epi8 (':'))),
+                _mm_or_si128 (_mm_cmpeq_epi8 (v, _mm_set1_epi8 ('(')),
+                              _mm_cmpeq_epi8 (v, _mm_set1_epi8 (')'))));
+
+        return _mm_or_si128 (punct, spaces16 (v));
+}
+
+static inline const char * spacesSSE2 (const char * p, const char * end)
+{
+        unsigned mask;
+
+        for ( ; end - p >= 16; p += 16 )
+        {
+            mask = ~_mm_movemask_epi8 (spaces16 (_mm_loadu_si128 ((const __m128i *) p))) & 0xffff;
+            if ( mask != 0 )
+                return p + __builtin_ctz (mask);
+        }
+        return spacesScalar (p, end);
+}
+
+static inline const char * delimiterSSE2 (const char * p, const char * end)
+{
+        unsigned mask;
+
+        for ( ; end - p >= 16; p += 16 )
+        {
+            mask = _mm_movemask_epi8 (delimiters16 (_mm_loadu_si128 ((const __m128i *) p)));
+            if ( mask != 0 )
+                return p + __builtin_ctz (mask);
+        }
+        return delimiterScalar (p, end);
+}
+
+static inline const char * commentSSE2 (const char * p, const char * end)
+{
+        unsigned mask;
+
+        for ( ; end - p >= 16; p += 16 )
+        {
+            mask = _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i *) p),
+                                                      _mm_set1_epi8 ('#')));
+            if ( mask != 0 )
+                return p + __builtin_ctz (mask);
+        }
+        return commentScalar (p, end);
+}
+
+
+/* AVX2 VERSIONS (32 characters at a time, then the SSE2 version for the rest) */
+
+#define AVX2 __attribute__ ((target ("avx2")))
+
+AVX2 static __m256i spaces32 (__m256i v)
+  /* Returns a mask with 0xff in each byte of v that is whitespace. */
+{
+        __m256i range = _mm256_sub_epi8 (v, _mm256_set1_epi8 ('\t'));
+
+        return _mm256_or_si256 (_mm256_cmpeq_epi8 (v, _mm256_set1_epi8 (' ')),
+                                _mm256_cmpeq_epi8 (_mm256_min_epu8 (range, _mm256_set1_epi8 ('\r' - '\t')), range));
+}
+
+AVX2 static __m256i delimiters32 (__m256i v)
+  /* Returns a mask with 0xff in each byte of v that is a delimiter. */
+{
+        __m256i punct = _mm256_or_si256 (
+                _mm256_or_si256 (_mm256_cmpeq_epi8 (v, _mm256_set1_epi8 (',')),
+                                 _mm256_cmpeq_epi8 (v, _mm256_set1_epi8 (':'))),
+                _mm256_or_si256 (_mm256_cmpeq_epi8 (v, _mm256_set1_epi8 ('(')),
+                                 _mm256_cmpeq_epi8 (v, _mm256_set1_epi8 (')'))));
+
+        return _mm256_or_si256 (punct, spaces32 (v));
+}
+
+AVX2 static const char * spacesAVX2 (const char * p, const char * end)
+{
+        unsigned mask;
+
+        for ( ; end - p >= 32; p += 32 )
+        {
+            mask = ~(unsigned) _mm256_movemask_epi8 (spaces32 (_mm256_loadu_si256 ((const __m256i *) p)));
+            if ( mask != 0 )
+                return p + __builtin_ctz (mask);
+        }
+        return spacesSSE2 (p, end);
+}
+
+AVX2 static const char * delimiterAVX2 (const char * p, const char * end)
+{
+        unsigned mask;
+
+        for ( ; end - p >= 32; p += 32 )
+        {
+            mask = (unsigned) _mm256_movemask_epi8 (delimiters32 (_mm256_loadu_si256 ((const __m256i *) p)));
+            if ( mask != 0 )
+                return p + __builtin_ctz (mask);
+        }
+        return delimiterSSE2 (p, end);
+}
+
+AVX2 static const char * commentAVX2 (const char * p, const char * end)
+{
+        unsigned mask;
+
+        for ( ; end - p >= 32; p += 32 )
+        {
+            mask = (unsigned) _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (_mm256_loadu_si256 ((const __m256i *) p),
+                                                                       _mm256_set1_epi8 ('#')));
+            if ( mask != 0 )
+                return p + __builtin_ctz (mask);
+        }
+        return commentSSE2 (p, end);
+}
+
+#endif
+
+
+/* SELECTING A VERSION */
+
+int scanSelect (int level)
+  /* Postcondition: The scanning functions use the fastest version, up to level, that the machine supports.
+   * Returns the version selected.
+   */
+{
+#if HAVE_X86_VECTORS
+        __builtin_cpu_init ();
+        if ( level >= SCAN_AVX2 && __builtin_cpu_supports ("avx2") )
+        {
+            spacesFn = spacesAVX2;
+            delimiterFn = delimiterAVX2;
+            commentFn = commentAVX2;
+            return SCAN_AVX2;
+        }
+        if ( level >= SCAN_SSE2 )
+        {
+            spacesFn = spacesSSE2;
+            delimiterFn = delimiterSSE2;
+            commentFn = commentSSE2;
+            return SCAN_SSE2;
+        }
+#else
+        (void) level;
+#endif
+
+        spacesFn = spacesScalar;
+        delimiterFn = delimiterScalar;
+        commentFn = commentScalar;
+        return SCAN_SCALAR;
+}
+
+static const char * spacesFirst (const char * p, const char * end)
+{
+        (void) scanSelect (SCAN_BEST);
+        return spacesFn (p, end);
+}
+
+static const char * delimiterFirst (const char * p, const char * end)
+{
+        (void) scanSelect (SCAN_BEST);
+        return delimiterFn (p, end);
+}
+
+static const char * commentFirst (const char * p, const char * end)
+{
+        (void) scanSelect (SCAN_BEST);
+        return commentFn (p, end);
+}
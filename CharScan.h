@@ -0,0 +1,69 @@
+/*
+ * Character Scanning: the inner loops of the tokenizer, a block at a time
+ *
+ * This file provides the declarations for a group of functions that find
+ * the next character of a given kind in a span of text.  getTokenN uses
+ * them to skip whitespace and to find the end of a token, and pass1 and
+ * pass2 use them to find the start of a comment.  They all behave the
+ * same way: they return a pointer to the first matching character
+ * between p and end, or end if there is none.  None of them stops at a
+ * null byte.
+ *
+ * Each function has three versions, which give the same results:
+ *      scalar  -- one character at a time (the original loops);
+ *      SSE2    -- 16 characters at a time (on any x86-64 machine);
+ *      AVX2    -- 32 characters at a time (on x86-64 machines that have it).
+ * The best version the machine supports is selected the first time any
+ * of the functions is called; scanSelect can select another (e.g., to
+ * compare them in a benchmark).  The vector versions only read whole
+ * blocks that lie before end, and finish the last few characters of a
+ * span one at a time.
+ *
+ * Whitespace means what isspace means in the C locale: space, tab,
+ * newline, vertical tab, form feed, and carriage return.  A delimiter is
+ * whitespace, a comma, a colon, or a left or right parenthesis (see
+ * getToken.h).
+ *
+ * CHAR_CLASS classifies every character value at once, so that a scalar
+ * loop can test a character against the whole set with one lookup instead
+ * of a chain of comparisons.  CHAR_CLASS[(unsigned char) c] is the
+ * combination of the CHAR_ flags that apply to c.
+ *
+ */
+
+#ifndef _CHAR_SCAN_H
+#define _CHAR_SCAN_H
+
+/* Versions of the scanning functions, from slowest to fastest. */
+#define SCAN_SCALAR  0
+#define SCAN_SSE2    1
+#define SCAN_AVX2    2
+#define SCAN_BEST    SCAN_AVX2
+
+/* Character classes (flags in CHAR_CLASS). */
+#define CHAR_SPACE      0x01    /* Whitespace. */
+#define CHAR_PUNCT      0x02    /* Comma, colon, or left or right parenthesis. */
+#define CHAR_COMMENT    0x04    /* '#', which starts a comment. */
+#define CHAR_NUL        0x08    /* The null byte, which ends a string. */
+#define CHAR_NUMBER     0x10    /* A digit or sign, which can begin an immediate value. */
+#define CHAR_DOLLAR     0x20    /* '$', which begins a register. */
+#define CHAR_DELIMITER  (CHAR_SPACE | CHAR_PUNCT)
+
+extern const unsigned char CHAR_CLASS[256];
+
+const char * scanSpaces (const char * p, const char * end);
+        /* Returns a pointer to the first character that is not whitespace, or end. */
+
+const char * scanDelimiter (const char * p, const char * end);
+        /* Returns a pointer to the first delimiter, or end. */
+
+const char * scanComment (const char * p, const char * end);
+        /* Returns a pointer to the first '#', or end. */
+
+int scanSelect (int level);
+        /* Postcondition: The scanning functions use the fastest version, up to level,
+         *                  that the machine supports.
+         * Returns the version selected (SCAN_SCALAR, SCAN_SSE2, or SCAN_AVX2).
+         */
+
+#endif
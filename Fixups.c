@@ -0,0 +1,178 @@
+/*
+ * Fixups: functions to record and patch forward label references
+ *
+ * This file provides the definitions of the functions declared in
+ * Fixups.h.  See that file for a description of fixups.
+ *
+ */
+
+#include <stdlib.h>
+
+#include "Fixups.h"
+#include "InstructionSet.h"
+#include "printFuncs.h"
+
+/* Internal global variables (global to this file only). */
+static const char * ERROR = "Error: cannot allocate space in memory.\n";
+
+void fixupInit (FixupList * list)
+  /* Postcondition: The list has no fixups. */
+{
+        list->capacity = 0;
+        list->nbrFixups = 0;
+        list->fixups = NULL;
+        tableInit (&list->pending);
+        list->headsCapacity = 0;
+        list->heads = NULL;
+        list->nbrUnresolved = 0;
+}
+
+int fixupAdd (FixupList * list, const LabelRef * ref, int wordNbr, int PC, int lineNum)
+  /* Postcondition: A fixup has been recorded for word wordNbr, waiting for the label ref refers to.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+        Fixup * newFixups;
+        int *   newHeads;
+        int     pendingNbr;
+        int     newCapacity;
+
+        /* Find the label's pending number, giving it the next one if it is new. */
+        pendingNbr = findLabelN (&list->pending, ref->begin, ref->length);
+        if ( pendingNbr == -1 )
+        {
+            pendingNbr = list->pending.nbrLabels;
+            if ( list->headsCapacity <= pendingNbr )
+            {
+                newCapacity = 2 * list->headsCapacity + 16;
+                if ((newHeads = realloc (list->heads, newCapacity * sizeof(int))) == NULL)
+                {
+                    printError ("%s", ERROR);
+                    return 0;       /* FATAL ERROR: Couldn't allocate memory. */
+                }
+                list->heads = newHeads;
+                list->headsCapacity = newCapacity;
+            }
+            if ( addLabelN (&list->pending, ref->begin, ref->length, pendingNbr) == 0 )
+                return 0;           /* Error message already printed by addLabelN. */
+            list->heads[pendingNbr] = -1;
+        }
+
+        /* Resize the fixup array if necessary. */
+        if ( list->nbrFixups >= list->capacity )
+        {
+            newCapacity = 2 * list->capacity + 16;
+            if ((newFixups = realloc (list->fixups, newCapacity * sizeof(Fixup))) == NULL)
+            {
+                printError ("%s", ERROR);
+                return 0;           /* FATAL ERROR: Couldn't allocate memory. */
+            }
+            list->fixups = newFixups;
+            list->capacity = newCapacity;
+        }
+
+        /* Record the fixup at the front of the label's chain. */
+        list->fixups[list->nbrFixups].wordNbr = wordNbr;
+        list->fixups[list->nbrFixups].PC = PC;
+        list->fixups[list->nbrFixups].lineNum = lineNum;
+        list->fixups[list->nbrFixups].use = ref->use;
+        list->fixups[list->nbrFixups].next = list->heads[pendingNbr];
+        list->heads[pendingNbr] = list->nbrFixups;
+        list->nbrFixups++;
+        list->nbrUnresolved++;
+
+        return 1;
+}
+
+int fixupResolve (FixupList * list, const char * labelBegin, size_t length, int address, WordBuffer * words)
+  /* Postcondition: Every fixup waiting for the label has been patched with address,
+   *                  or reported if the label is out of its range.
+   * Returns the number of words patched.
+   */
+{
+        Fixup * fixup;
+        int     pendingNbr;
+        int     i;
+        int     nbrPatched = 0;
+        int     nbrResolved = 0;
+
+        /* Most labels are defined before they are used, so there is usually nothing to do. */
+        if ( list->nbrUnresolved == 0 )
+            return 0;
+        if ( (pendingNbr = findLabelN (&list->pending, labelBegin, length)) == -1 )
+            return 0;
+
+        /* Patch every word in the label's chain, then empty the chain.  A word the label
+         *  is out of reach of keeps its field zero.
+         */
+        for ( i = list->heads[pendingNbr]; i != -1; i = fixup->next )
+        {
+            fixup = &list->fixups[i];
+            if ( patchLabel (&words->words[fixup->wordNbr], fixup->use, address, fixup->PC) )
+                nbrPatched++;
+            else
+                printError ("Error on line %d: branch target %.*s is out of range.\n",
+                            fixup->lineNum, (int) length, labelBegin);
+            nbrResolved++;
+        }
+        list->heads[pendingNbr] = -1;
+        list->nbrUnresolved -= nbrResolved;
+
+        return nbrPatched;
+}
+
+int fixupReportUnresolved (FixupList * list)
+  /* Postcondition: An error has been printed for every fixup still waiting for its label.
+   * Returns the number of such fixups.
+   */
+{
+        int pendingNbr;
+        int i;
+
+        /* A label's pending number is also its entry number in the pending table. */
+        for ( pendingNbr = 0; pendingNbr < list->pending.nbrLabels; pendingNbr++ )
+            for ( i = list->heads[pendingNbr]; i != -1; i = list->fixups[i].next )
+                printError ("Error on line %d: label %s is not defined.\n",
+                            list->fixups[i].lineNum, list->pending.entries[pendingNbr].label);
+
+        return list->nbrUnresolved;
+}
+
+void fixupDestroy (FixupList * list)
+  /* Postcondition: The list's memory has been freed and the list has no fixups. */
+{
+        free (list->fixups);
+        free (list->heads);
+        tableDestroy (&list->pending);
+        fixupInit (list);
+}
+
+int patchLabel (uint32_t * word, int use, int labelAddress, int PC)
+  /* Postcondition: The label field of *word holds labelAddress as seen from PC,
+   *                  unless it is out of the range of the field (see FIELDS).
+   * Returns 1 if the field was patched; 0 if the label is out of range.
+   */
+{
+        const Field * field;
+        long  value;
+
+        if ( use == LABEL_BRANCH )
+        {
+            /* Branch offsets count words from the instruction after the branch. */
+            field = &FIELDS[FIELD_BRANCH];
+            value = ((long) labelAddress - (PC + 4)) / 4;
+        }
+        else if ( use == LABEL_JUMP )
+        {
+            /* Jump targets are word addresses within the 256 MB region of the instruction after the jump. */
+            field = &FIELDS[FIELD_TARGET];
+            value = ((long) labelAddress - (long) ((uint32_t) (PC + 4) & 0xf0000000u)) / 4;
+        }
+        else
+            return 1;               /* Nothing to patch. */
+
+        if ( value < field->min || value > field->max )
+            return 0;
+        *word = (*word & ~(field->mask << field->shift)) | ((uint32_t) value & field->mask) << field->shift;
+        return 1;
+}
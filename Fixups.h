@@ -0,0 +1,102 @@
+/*
+ * Fixups: forward label references waiting to be patched
+ *
+ * This file provides the data structures and declarations for a group
+ * of functions that let instructions be encoded before the labels they
+ * refer to have been defined.  When an instruction refers to a label
+ * that is not yet in the label table, its word is emitted with the label
+ * field left as zero and a fixup is recorded.  When the label is later
+ * defined, every fixup waiting for it is resolved by patching the label's
+ * address into the words that refer to it.
+ *
+ * Fixups waiting for the same label are chained together, so defining a
+ * label patches exactly the words that refer to it, without scanning the
+ * whole list.
+ *
+ */
+
+#ifndef _FIXUPS_H
+#define _FIXUPS_H
+
+#include <stdint.h>
+
+#include "LabelTable.h"
+#include "WordBuffer.h"
+
+/* THE DATA STRUCTURES */
+
+/* How an instruction uses a label operand, which determines how the
+ * label's address is packed into the instruction word.
+ */
+#define LABEL_NONE    0     /* The instruction has no label operand. */
+#define LABEL_BRANCH  1     /* 16-bit offset, in words, from PC + 4 (e.g., beq, bne). */
+#define LABEL_JUMP    2     /* 26-bit word address (e.g., j, jal). */
+
+typedef struct {
+        const char * begin;     /* First character of the label operand. */
+        size_t length;          /* Number of characters in the label operand. */
+        int    use;             /* LABEL_NONE, LABEL_BRANCH, or LABEL_JUMP. */
+} LabelRef;
+
+typedef struct {
+        int wordNbr;            /* Number of the word to patch. */
+        int PC;                 /* Address of the instruction containing the reference. */
+        int lineNum;            /* Line of the reference, for error messages. */
+        int use;                /* LABEL_BRANCH or LABEL_JUMP. */
+        int next;               /* Next fixup waiting for the same label, or -1. */
+} Fixup;
+
+typedef struct {
+        int        capacity;    /* Capacity of the fixup array. */
+        int        nbrFixups;   /* Actual number of fixups recorded. */
+        Fixup *    fixups;
+        LabelTable pending;     /* Labels referenced before being defined;
+                                 *   the "address" of each is its pending number. */
+        int        headsCapacity;
+        int *      heads;       /* heads[n]: most recent fixup waiting for pending label n, or -1. */
+        int        nbrUnresolved;   /* Number of fixups not yet patched. */
+} FixupList;
+
+
+/* THE FUNCTIONS */
+
+void fixupInit (FixupList * list);
+        /* Postcondition: The list has no fixups. */
+
+int fixupAdd (FixupList * list, const LabelRef * ref, int wordNbr, int PC, int lineNum);
+        /* Postcondition: A fixup has been recorded for word wordNbr, waiting for the label ref refers to.
+         *
+         * Returns 1 if everything went OK;
+         *         0 if memory allocation error
+         */
+
+int fixupResolve (FixupList * list, const char * labelBegin, size_t length, int address, WordBuffer * words);
+        /* Postcondition: Every fixup waiting for the label that is the length characters starting at
+         *                  labelBegin has been patched in words with address, and is no longer waiting.
+         *                  A fixup the address is out of range of has been reported as an error
+         *                  instead (see patchLabel), using the line number it was recorded with.
+         *
+         * Returns the number of words patched.
+         */
+
+int fixupReportUnresolved (FixupList * list);
+        /* Postcondition: An error has been printed for every fixup still waiting for its label.
+         *
+         * Returns the number of such fixups.
+         */
+
+void fixupDestroy (FixupList * list);
+        /* Postcondition: The list's memory has been freed and the list has no fixups. */
+
+int patchLabel (uint32_t * word, int use, int labelAddress, int PC);
+        /* Postcondition: The label field of *word, as determined by use, holds labelAddress
+         *                  as seen from the instruction at address PC, unless the value
+         *                  to put there is out of the field's range (see FIELD_BRANCH and
+         *                  FIELD_TARGET in InstructionSet.h), in which case *word is
+         *                  unchanged.
+         *
+         * Returns 1 if the field was patched;
+         *         0 if labelAddress is out of range
+         */
+
+#endif
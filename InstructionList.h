@@ -0,0 +1,112 @@
+/*
+ * Instruction List: the MIPS instructions and registers the assembler knows
+ *
+ * This file is the one place where instruction mnemonics and register
+ * names are listed.  It is not an ordinary header: it is included after
+ * defining the macros
+ *      INSTRUCTION(name, format, opcode, funct)
+ *      REGISTER(name, number)
+ * to do something with each entry (see genTables.c, which builds the
+ * perfect-hash lookup tables in InstructionTables.h from this list).
+ * format names the entry in FORMATS (see InstructionSet.h) that says
+ * which operands the instruction takes and where each one goes;
+ * funct is 0 for instructions that are not R format.
+ *
+ */
+
+/* R format: arithmetic, logic, and shifts. */
+INSTRUCTION("add",     FORMAT_R_RD_RS_RT,     0x00, 0x20)
+INSTRUCTION("addu",    FORMAT_R_RD_RS_RT,     0x00, 0x21)
+INSTRUCTION("sub",     FORMAT_R_RD_RS_RT,     0x00, 0x22)
+INSTRUCTION("subu",    FORMAT_R_RD_RS_RT,     0x00, 0x23)
+INSTRUCTION("and",     FORMAT_R_RD_RS_RT,     0x00, 0x24)
+INSTRUCTION("or",      FORMAT_R_RD_RS_RT,     0x00, 0x25)
+INSTRUCTION("xor",     FORMAT_R_RD_RS_RT,     0x00, 0x26)
+INSTRUCTION("nor",     FORMAT_R_RD_RS_RT,     0x00, 0x27)
+INSTRUCTION("slt",     FORMAT_R_RD_RS_RT,     0x00, 0x2a)
+INSTRUCTION("sltu",    FORMAT_R_RD_RS_RT,     0x00, 0x2b)
+INSTRUCTION("sll",     FORMAT_R_RD_RT_SHAMT,  0x00, 0x00)
+INSTRUCTION("srl",     FORMAT_R_RD_RT_SHAMT,  0x00, 0x02)
+INSTRUCTION("sra",     FORMAT_R_RD_RT_SHAMT,  0x00, 0x03)
+INSTRUCTION("sllv",    FORMAT_R_RD_RT_RS,     0x00, 0x04)
+INSTRUCTION("srlv",    FORMAT_R_RD_RT_RS,     0x00, 0x06)
+INSTRUCTION("srav",    FORMAT_R_RD_RT_RS,     0x00, 0x07)
+INSTRUCTION("jr",      FORMAT_R_RS,           0x00, 0x08)
+INSTRUCTION("jalr",    FORMAT_R_RD_RS,        0x00, 0x09)
+INSTRUCTION("syscall", FORMAT_R_NONE,         0x00, 0x0c)
+INSTRUCTION("mfhi",    FORMAT_R_RD,           0x00, 0x10)
+INSTRUCTION("mflo",    FORMAT_R_RD,           0x00, 0x12)
+INSTRUCTION("mult",    FORMAT_R_RS_RT,        0x00, 0x18)
+INSTRUCTION("multu",   FORMAT_R_RS_RT,        0x00, 0x19)
+INSTRUCTION("div",     FORMAT_R_RS_RT,        0x00, 0x1a)
+INSTRUCTION("divu",    FORMAT_R_RS_RT,        0x00, 0x1b)
+
+/* I format: immediates, branches, loads, and stores. */
+INSTRUCTION("addi",    FORMAT_I_RT_RS_IMM,    0x08, 0)
+INSTRUCTION("addiu",   FORMAT_I_RT_RS_IMM,    0x09, 0)
+INSTRUCTION("slti",    FORMAT_I_RT_RS_IMM,    0x0a, 0)
+INSTRUCTION("sltiu",   FORMAT_I_RT_RS_IMM,    0x0b, 0)
+INSTRUCTION("andi",    FORMAT_I_RT_RS_UIMM,   0x0c, 0)
+INSTRUCTION("ori",     FORMAT_I_RT_RS_UIMM,   0x0d, 0)
+INSTRUCTION("xori",    FORMAT_I_RT_RS_UIMM,   0x0e, 0)
+INSTRUCTION("lui",     FORMAT_I_RT_UIMM,      0x0f, 0)
+INSTRUCTION("beq",     FORMAT_I_RS_RT_LABEL,  0x04, 0)
+INSTRUCTION("bne",     FORMAT_I_RS_RT_LABEL,  0x05, 0)
+INSTRUCTION("blez",    FORMAT_I_RS_LABEL,     0x06, 0)
+INSTRUCTION("bgtz",    FORMAT_I_RS_LABEL,     0x07, 0)
+INSTRUCTION("lb",      FORMAT_I_RT_OFFSET_RS, 0x20, 0)
+INSTRUCTION("lh",      FORMAT_I_RT_OFFSET_RS, 0x21, 0)
+INSTRUCTION("lw",      FORMAT_I_RT_OFFSET_RS, 0x23, 0)
+INSTRUCTION("lbu",     FORMAT_I_RT_OFFSET_RS, 0x24, 0)
+INSTRUCTION("lhu",     FORMAT_I_RT_OFFSET_RS, 0x25, 0)
+INSTRUCTION("sb",      FORMAT_I_RT_OFFSET_RS, 0x28, 0)
+INSTRUCTION("sh",      FORMAT_I_RT_OFFSET_RS, 0x29, 0)
+INSTRUCTION("sw",      FORMAT_I_RT_OFFSET_RS, 0x2b, 0)
+
+/* J format: jumps. */
+INSTRUCTION("j",       FORMAT_J_LABEL,        0x02, 0)
+INSTRUCTION("jal",     FORMAT_J_LABEL,        0x03, 0)
+
+/* Registers, by name. */
+REGISTER("$zero", 0)
+REGISTER("$at",   1)
+REGISTER("$v0",   2)
+REGISTER("$v1",   3)
+REGISTER("$a0",   4)
+REGISTER("$a1",   5)
+REGISTER("$a2",   6)
+REGISTER("$a3",   7)
+REGISTER("$t0",   8)
+REGISTER("$t1",   9)
+REGISTER("$t2",  10)
+REGISTER("$t3",  11)
+REGISTER("$t4",  12)
+REGISTER("$t5",  13)
+REGISTER("$t6",  14)
+REGISTER("$t7",  15)
+REGISTER("$s0",  16)
+REGISTER("$s1",  17)
+REGISTER("$s2",  18)
+REGISTER("$s3",  19)
+REGISTER("$s4",  20)
+REGISTER("$s5",  21)
+REGISTER("$s6",  22)
+REGISTER("$s7",  23)
+REGISTER("$t8",  24)
+REGISTER("$t9",  25)
+REGISTER("$k0",  26)
+REGISTER("$k1",  27)
+REGISTER("$gp",  28)
+REGISTER("$sp",  29)
+REGISTER("$fp",  30)
+REGISTER("$ra",  31)
+
+/* Registers, by number. */
+REGISTER("$0",  0)  REGISTER("$1",  1)  REGISTER("$2",  2)  REGISTER("$3",  3)
+REGISTER("$4",  4)  REGISTER("$5",  5)  REGISTER("$6",  6)  REGISTER("$7",  7)
+REGISTER("$8",  8)  REGISTER("$9",  9)  REGISTER("$10", 10) REGISTER("$11", 11)
+REGISTER("$12", 12) REGISTER("$13", 13) REGISTER("$14", 14) REGISTER("$15", 15)
+REGISTER("$16", 16) REGISTER("$17", 17) REGISTER("$18", 18) REGISTER("$19", 19)
+REGISTER("$20", 20) REGISTER("$21", 21) REGISTER("$22", 22) REGISTER("$23", 23)
+REGISTER("$24", 24) REGISTER("$25", 25) REGISTER("$26", 26) REGISTER("$27", 27)
+REGISTER("$28", 28) REGISTER("$29", 29) REGISTER("$30", 30) REGISTER("$31", 31)
@@ -0,0 +1,64 @@
+/*
+ * Instruction Set: looking up MIPS instruction mnemonics and register names
+ *
+ * This file provides the definitions of the functions and the encoding
+ * tables declared in InstructionSet.h.  The tables the functions search
+ * are in InstructionTables.h, which genTables writes when the assembler
+ * is built.
+ *
+ */
+
+#include "InstructionSet.h"
+#include "InstructionTables.h"
+#include "getToken.h"
+
+/* The fields an operand can fill (indexed by FIELD_RS, etc.). */
+const Field FIELDS[] = {
+        [FIELD_RS]     = { 21, 0x1f,      TOKEN_REGISTER,  "register",                  0, 31 },
+        [FIELD_RT]     = { 16, 0x1f,      TOKEN_REGISTER,  "register",                  0, 31 },
+        [FIELD_RD]     = { 11, 0x1f,      TOKEN_REGISTER,  "register",                  0, 31 },
+        [FIELD_SHAMT]  = {  6, 0x1f,      TOKEN_IMMEDIATE, "shift amount",              0, 31 },
+        [FIELD_IMM]    = {  0, 0xffff,    TOKEN_IMMEDIATE, "immediate value",           -32768, 32767 },
+        [FIELD_UIMM]   = {  0, 0xffff,    TOKEN_IMMEDIATE, "unsigned immediate value",  0, 65535 },
+        [FIELD_OFFSET] = {  0, 0xffff,    TOKEN_MEMORY,    "memory operand",            -32768, 32767 },
+        [FIELD_BRANCH] = {  0, 0xffff,    TOKEN_LABEL,     "label",                     -32768, 32767 },
+        [FIELD_TARGET] = {  0, 0x3ffffff, TOKEN_LABEL,     "label",                     0, 0x3ffffff }
+};
+
+/* The ways operands can be written (indexed by FORMAT_R_RD_RS_RT, etc.). */
+const Format FORMATS[] = {
+        [FORMAT_R_RD_RS_RT]     = { 3, { FIELD_RD, FIELD_RS, FIELD_RT } },
+        [FORMAT_R_RD_RT_SHAMT]  = { 3, { FIELD_RD, FIELD_RT, FIELD_SHAMT } },
+        [FORMAT_R_RD_RT_RS]     = { 3, { FIELD_RD, FIELD_RT, FIELD_RS } },
+        [FORMAT_R_RS_RT]        = { 2, { FIELD_RS, FIELD_RT } },
+        [FORMAT_R_RD_RS]        = { 2, { FIELD_RD, FIELD_RS } },
+        [FORMAT_R_RS]           = { 1, { FIELD_RS } },
+        [FORMAT_R_RD]           = { 1, { FIELD_RD } },
+        [FORMAT_R_NONE]         = { 0, { 0 } },
+        [FORMAT_I_RT_RS_IMM]    = { 3, { FIELD_RT, FIELD_RS, FIELD_IMM } },
+        [FORMAT_I_RT_RS_UIMM]   = { 3, { FIELD_RT, FIELD_RS, FIELD_UIMM } },
+        [FORMAT_I_RT_UIMM]      = { 2, { FIELD_RT, FIELD_UIMM } },
+        [FORMAT_I_RT_OFFSET_RS] = { 3, { FIELD_RT, FIELD_OFFSET, FIELD_RS } },
+        [FORMAT_I_RS_RT_LABEL]  = { 3, { FIELD_RS, FIELD_RT, FIELD_BRANCH } },
+        [FORMAT_I_RS_LABEL]     = { 2, { FIELD_RS, FIELD_BRANCH } },
+        [FORMAT_J_LABEL]        = { 1, { FIELD_TARGET } }
+};
+
+const Mnemonic * lookupMnemonic (const char * begin, size_t length)
+  /* Returns the instruction named by begin..begin+length, or NULL if there is none. */
+{
+        uint64_t key = packName (begin, length);
+        const Mnemonic * slot = &MNEMONIC_TABLE[(key * MNEMONIC_MULTIPLIER) >> MNEMONIC_SHIFT];
+
+        /* An empty slot has key 0, which no name packs to, so it never matches. */
+        return key != 0 && slot->key == key ? slot : NULL;
+}
+
+int lookupRegister (const char * begin, size_t length)
+  /* Returns the number of the register named by begin..begin+length, or -1 if there is none. */
+{
+        uint64_t key = packName (begin, length);
+        const RegisterName * slot = &REGISTER_TABLE[(key * REGISTER_MULTIPLIER) >> REGISTER_SHIFT];
+
+        return key != 0 && slot->key == key ? slot->number : -1;
+}
@@ -0,0 +1,137 @@
+/*
+ * Instruction Set: looking up MIPS instruction mnemonics and register names
+ *
+ * This file provides the data structures and declarations for the
+ * functions that turn an instruction name (e.g., "addi") into its format
+ * and opcode and function codes, and a register name (e.g., "$t0" or
+ * "$8") into its number.
+ *
+ * It also describes how to encode an instruction, with two tables:
+ *      FIELDS  -- for each field of an instruction word that an operand can
+ *                 fill: where the field is in the word (its shift and mask),
+ *                 what kind of token fills it, and the range of values it
+ *                 takes;
+ *      FORMATS -- for each format, i.e., each way the operands of an
+ *                 instruction can be written: how many operands there are,
+ *                 and which field each one fills, in the order they are
+ *                 written.
+ * Every instruction is encoded by the same loop over its format's
+ * operands (see processInstruction in pass2.c), so adding an instruction
+ * only takes a line in InstructionList.h, and adding a new way of writing
+ * operands only takes an entry in FORMATS.
+ *
+ * Both lookups use perfect-hash tables that are generated when the
+ * assembler is built (see genTables.c and InstructionList.h), so a lookup
+ * takes the same few instructions whatever the name: the name's
+ * characters (at most MAX_NAME_LENGTH of them) and its length are packed
+ * into one 64-bit key, the key is multiplied by a constant chosen so that
+ * no two names share a slot, and the top bits of the product select the
+ * one slot where the name can be.  Comparing the key with the slot's key
+ * then decides whether it is there.  No strings are compared.
+ *
+ */
+
+#ifndef _INSTRUCTION_SET_H
+#define _INSTRUCTION_SET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Fields an operand can fill (indexes into FIELDS). */
+#define FIELD_RS      0     /* Source register, bits 25-21. */
+#define FIELD_RT      1     /* Target register, bits 20-16. */
+#define FIELD_RD      2     /* Destination register, bits 15-11. */
+#define FIELD_SHAMT   3     /* Shift amount, bits 10-6. */
+#define FIELD_IMM     4     /* Signed immediate value (e.g., of addi), bits 15-0. */
+#define FIELD_UIMM    5     /* Unsigned immediate value (e.g., of andi or lui), bits 15-0. */
+#define FIELD_OFFSET  6     /* Offset of a memory operand, e.g., the 4 in 4($sp), bits 15-0. */
+#define FIELD_BRANCH  7     /* Branch target label, as a word offset from PC + 4, bits 15-0. */
+#define FIELD_TARGET  8     /* Jump target label, as a word address within the 256 MB
+                             *   region of PC + 4, bits 25-0. */
+
+/* Instruction formats (indexes into FORMATS), named by their operands in the order they are written. */
+#define FORMAT_R_RD_RS_RT      0    /* add $rd, $rs, $rt */
+#define FORMAT_R_RD_RT_SHAMT   1    /* sll $rd, $rt, shamt */
+#define FORMAT_R_RD_RT_RS      2    /* sllv $rd, $rt, $rs */
+#define FORMAT_R_RS_RT         3    /* mult $rs, $rt */
+#define FORMAT_R_RD_RS         4    /* jalr $rd, $rs */
+#define FORMAT_R_RS            5    /* jr $rs */
+#define FORMAT_R_RD            6    /* mfhi $rd */
+#define FORMAT_R_NONE          7    /* syscall */
+#define FORMAT_I_RT_RS_IMM     8    /* addi $rt, $rs, imm */
+#define FORMAT_I_RT_RS_UIMM    9    /* andi $rt, $rs, uimm */
+#define FORMAT_I_RT_UIMM       10   /* lui $rt, uimm */
+#define FORMAT_I_RT_OFFSET_RS  11   /* lw $rt, offset($rs) */
+#define FORMAT_I_RS_RT_LABEL   12   /* beq $rs, $rt, label */
+#define FORMAT_I_RS_LABEL      13   /* blez $rs, label */
+#define FORMAT_J_LABEL         14   /* j label */
+
+/* Most operands an instruction takes. */
+#define MAX_OPERANDS 3
+
+/* Longest name that can be packed into a key (the eighth byte holds the length). */
+#define MAX_NAME_LENGTH 7
+
+
+/* THE DATA STRUCTURES */
+
+typedef struct {
+        uint64_t key;           /* Packed name (see packName), or 0 if the slot is empty. */
+        const char * name;      /* Mnemonic (e.g., "addi"). */
+        int      format;        /* How its operands are written and encoded (e.g., FORMAT_R_RD_RS_RT). */
+        unsigned opcode;        /* Opcode (bits 31-26 of the instruction). */
+        unsigned funct;         /* Function code (bits 5-0) of an R-format instruction. */
+} Mnemonic;
+
+typedef struct {
+        uint64_t key;           /* Packed name (see packName), or 0 if the slot is empty. */
+        int      number;        /* Register number (0 to 31). */
+} RegisterName;
+
+typedef struct {
+        unsigned shift;         /* Position of the field's lowest bit in the word. */
+        uint32_t mask;          /* Mask of the field's bits, before shifting. */
+        int      tokenKind;     /* Kind of token that fills the field (see TokenSpan in getToken.h). */
+        const char * what;      /* What the token should be, for error messages (e.g., "register"). */
+        long     min, max;      /* Range of values the field can take; for a label, the range
+                                 *   of the offset or address patched in (see patchLabel). */
+} Field;
+
+typedef struct {
+        int      nbrOperands;   /* Number of operands. */
+        int      operands[MAX_OPERANDS];  /* Field that each operand fills, in the order they are written. */
+} Format;
+
+extern const Field FIELDS[];
+extern const Format FORMATS[];
+
+
+/* THE FUNCTIONS */
+
+static inline uint64_t packName (const char * begin, size_t length)
+  /* Returns the key for the name begin..begin+length: its characters in the
+   *  low bytes, in order, and its length in the high byte; or 0 if the name
+   *  is empty or longer than MAX_NAME_LENGTH characters.
+   */
+{
+        uint64_t key = 0;
+        size_t   i;
+
+        if ( length == 0 || length > MAX_NAME_LENGTH )
+            return 0;
+        for ( i = 0; i < length; i++ )
+            key |= (uint64_t) (unsigned char) begin[i] << (8 * i);
+        return key | (uint64_t) length << 56;
+}
+
+const Mnemonic * lookupMnemonic (const char * begin, size_t length);
+        /* Returns the instruction named by begin..begin+length,
+         *  or NULL if there is no such instruction.
+         */
+
+int lookupRegister (const char * begin, size_t length);
+        /* Returns the number of the register named by begin..begin+length
+         *  (e.g., 8 for "$t0" or "$8"), or -1 if there is no such register.
+         */
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ * Perfect-hash tables for InstructionSet.c, generated by genTables
+ * from InstructionList.h.  Do not edit this file; edit the list instead.
+ */
+
+#define MNEMONIC_MULTIPLIER 0x03a4a89b784afac1ULL
+#define MNEMONIC_SHIFT      57
+#define MNEMONIC_SLOTS      128
+
+static const Mnemonic MNEMONIC_TABLE[MNEMONIC_SLOTS] = {
+        [  2] = { 0x0500007569746c73ULL, "sltiu", FORMAT_I_RT_RS_IMM, 0x0b, 0x00 },
+        [  4] = { 0x0200000000006873ULL, "sh", FORMAT_I_RT_OFFSET_RS, 0x29, 0x00 },
+        [  5] = { 0x0300000000716562ULL, "beq", FORMAT_I_RS_RT_LABEL, 0x04, 0x00 },
+        [  9] = { 0x0500007569646461ULL, "addiu", FORMAT_I_RT_RS_IMM, 0x09, 0x00 },
+        [ 10] = { 0x020000000000626cULL, "lb", FORMAT_I_RT_OFFSET_RS, 0x20, 0x00 },
+        [ 13] = { 0x0300000000617273ULL, "sra", FORMAT_R_RD_RT_SHAMT, 0x00, 0x03 },
+        [ 16] = { 0x05000075746c756dULL, "multu", FORMAT_R_RS_RT, 0x00, 0x19 },
+        [ 19] = { 0x040000007a746762ULL, "bgtz", FORMAT_I_RS_LABEL, 0x07, 0x00 },
+        [ 22] = { 0x0200000000006273ULL, "sb", FORMAT_I_RT_OFFSET_RS, 0x28, 0x00 },
+        [ 26] = { 0x030000000069756cULL, "lui", FORMAT_I_RT_UIMM, 0x0f, 0x00 },
+        [ 32] = { 0x0300000000646e61ULL, "and", FORMAT_R_RD_RS_RT, 0x00, 0x24 },
+        [ 33] = { 0x010000000000006aULL, "j", FORMAT_J_LABEL, 0x02, 0x00 },
+        [ 35] = { 0x04000000726c616aULL, "jalr", FORMAT_R_RD_RS, 0x00, 0x09 },
+        [ 36] = { 0x0400000069746c73ULL, "slti", FORMAT_I_RT_RS_IMM, 0x0a, 0x00 },
+        [ 37] = { 0x03000000006c616aULL, "jal", FORMAT_J_LABEL, 0x03, 0x00 },
+        [ 39] = { 0x0300000000726f6eULL, "nor", FORMAT_R_RD_RS_RT, 0x00, 0x27 },
+        [ 41] = { 0x030000000069726fULL, "ori", FORMAT_I_RT_RS_UIMM, 0x0d, 0x00 },
+        [ 43] = { 0x020000000000726aULL, "jr", FORMAT_R_RS, 0x00, 0x08 },
+        [ 44] = { 0x0400000069646461ULL, "addi", FORMAT_I_RT_RS_IMM, 0x08, 0x00 },
+        [ 45] = { 0x03000000006c7273ULL, "srl", FORMAT_R_RD_RT_SHAMT, 0x00, 0x02 },
+        [ 51] = { 0x04000000746c756dULL, "mult", FORMAT_R_RS_RT, 0x00, 0x18 },
+        [ 52] = { 0x020000000000726fULL, "or", FORMAT_R_RD_RS_RT, 0x00, 0x25 },
+        [ 55] = { 0x040000006968666dULL, "mfhi", FORMAT_R_RD, 0x00, 0x10 },
+        [ 57] = { 0x0300000000726f78ULL, "xor", FORMAT_R_RD_RS_RT, 0x00, 0x26 },
+        [ 62] = { 0x040000007a656c62ULL, "blez", FORMAT_I_RS_LABEL, 0x06, 0x00 },
+        [ 63] = { 0x03000000006c6c73ULL, "sll", FORMAT_R_RD_RT_SHAMT, 0x00, 0x00 },
+        [ 64] = { 0x0400000075627573ULL, "subu", FORMAT_R_RD_RS_RT, 0x00, 0x23 },
+        [ 67] = { 0x0400000076617273ULL, "srav", FORMAT_R_RD_RT_RS, 0x00, 0x07 },
+        [ 73] = { 0x0400000075746c73ULL, "sltu", FORMAT_R_RD_RS_RT, 0x00, 0x2b },
+        [ 74] = { 0x020000000000776cULL, "lw", FORMAT_I_RT_OFFSET_RS, 0x23, 0x00 },
+        [ 77] = { 0x076c6c6163737973ULL, "syscall", FORMAT_R_NONE, 0x00, 0x0c },
+        [ 80] = { 0x0400000075646461ULL, "addu", FORMAT_R_RD_RS_RT, 0x00, 0x21 },
+        [ 87] = { 0x0200000000007773ULL, "sw", FORMAT_I_RT_OFFSET_RS, 0x2b, 0x00 },
+        [ 89] = { 0x0300000000627573ULL, "sub", FORMAT_R_RD_RS_RT, 0x00, 0x22 },
+        [ 91] = { 0x040000006f6c666dULL, "mflo", FORMAT_R_RD, 0x00, 0x12 },
+        [ 95] = { 0x0400000075766964ULL, "divu", FORMAT_R_RS_RT, 0x00, 0x1b },
+        [ 96] = { 0x030000000075686cULL, "lhu", FORMAT_I_RT_OFFSET_RS, 0x25, 0x00 },
+        [ 97] = { 0x0300000000746c73ULL, "slt", FORMAT_R_RD_RS_RT, 0x00, 0x2a },
+        [ 98] = { 0x04000000766c7273ULL, "srlv", FORMAT_R_RD_RT_RS, 0x00, 0x06 },
+        [ 99] = { 0x0400000069646e61ULL, "andi", FORMAT_I_RT_RS_UIMM, 0x0c, 0x00 },
+        [105] = { 0x0300000000646461ULL, "add", FORMAT_R_RD_RS_RT, 0x00, 0x20 },
+        [114] = { 0x030000000075626cULL, "lbu", FORMAT_I_RT_OFFSET_RS, 0x24, 0x00 },
+        [116] = { 0x04000000766c6c73ULL, "sllv", FORMAT_R_RD_RT_RS, 0x00, 0x04 },
+        [118] = { 0x0300000000656e62ULL, "bne", FORMAT_I_RS_RT_LABEL, 0x05, 0x00 },
+        [119] = { 0x020000000000686cULL, "lh", FORMAT_I_RT_OFFSET_RS, 0x21, 0x00 },
+        [120] = { 0x0300000000766964ULL, "div", FORMAT_R_RS_RT, 0x00, 0x1a },
+        [123] = { 0x0400000069726f78ULL, "xori", FORMAT_I_RT_RS_UIMM, 0x0e, 0x00 },
+};
+
+#define REGISTER_MULTIPLIER 0x4f97e8078ee6de8bULL
+#define REGISTER_SHIFT      57
+#define REGISTER_SLOTS      128
+
+static const RegisterName REGISTER_TABLE[REGISTER_SLOTS] = {
+        [  0] = { 0x0300000000367324ULL, 22 },   /* $s6 */
+        [  3] = { 0x0300000000343124ULL, 14 },   /* $14 */
+        [  8] = { 0x0300000000317424ULL, 9 },   /* $t1 */
+        [ 12] = { 0x0300000000357324ULL, 21 },   /* $s5 */
+        [ 13] = { 0x0200000000003924ULL, 9 },   /* $9 */
+        [ 15] = { 0x0300000000333124ULL, 13 },   /* $13 */
+        [ 17] = { 0x0200000000003424ULL, 4 },   /* $4 */
+        [ 19] = { 0x0300000000393224ULL, 29 },   /* $29 */
+        [ 20] = { 0x0300000000307424ULL, 8 },   /* $t0 */
+        [ 21] = { 0x0500006f72657a24ULL, 0 },   /* $zero */
+        [ 24] = { 0x0300000000347324ULL, 20 },   /* $s4 */
+        [ 27] = { 0x0300000000323124ULL, 12 },   /* $12 */
+        [ 31] = { 0x0300000000383224ULL, 28 },   /* $28 */
+        [ 32] = { 0x0300000000317624ULL, 3 },   /* $v1 */
+        [ 36] = { 0x0300000000337324ULL, 19 },   /* $s3 */
+        [ 39] = { 0x0300000000313124ULL, 11 },   /* $11 */
+        [ 40] = { 0x0300000000397424ULL, 25 },   /* $t9 */
+        [ 41] = { 0x0200000000003624ULL, 6 },   /* $6 */
+        [ 43] = { 0x0300000000373224ULL, 27 },   /* $27 */
+        [ 44] = { 0x0300000000307624ULL, 2 },   /* $v0 */
+        [ 45] = { 0x0200000000003124ULL, 1 },   /* $1 */
+        [ 48] = { 0x0300000000327324ULL, 18 },   /* $s2 */
+        [ 49] = { 0x0300000000617224ULL, 31 },   /* $ra */
+        [ 51] = { 0x0300000000303124ULL, 10 },   /* $10 */
+        [ 52] = { 0x0300000000387424ULL, 24 },   /* $t8 */
+        [ 55] = { 0x0300000000363224ULL, 26 },   /* $26 */
+        [ 58] = { 0x0300000000706724ULL, 28 },   /* $gp */
+        [ 60] = { 0x0300000000317324ULL, 17 },   /* $s1 */
+        [ 63] = { 0x0300000000313324ULL, 31 },   /* $31 */
+        [ 64] = { 0x0300000000377424ULL, 15 },   /* $t7 */
+        [ 65] = { 0x0200000000003824ULL, 8 },   /* $8 */
+        [ 66] = { 0x0300000000746124ULL, 1 },   /* $at */
+        [ 67] = { 0x0300000000353224ULL, 25 },   /* $25 */
+        [ 69] = { 0x0200000000003324ULL, 3 },   /* $3 */
+        [ 71] = { 0x0300000000393124ULL, 19 },   /* $19 */
+        [ 72] = { 0x0300000000307324ULL, 16 },   /* $s0 */
+        [ 73] = { 0x0300000000707324ULL, 29 },   /* $sp */
+        [ 75] = { 0x0300000000303324ULL, 30 },   /* $30 */
+        [ 76] = { 0x0300000000367424ULL, 14 },   /* $t6 */
+        [ 77] = { 0x0300000000336124ULL, 7 },   /* $a3 */
+        [ 79] = { 0x0300000000343224ULL, 24 },   /* $24 */
+        [ 83] = { 0x0300000000383124ULL, 18 },   /* $18 */
+        [ 88] = { 0x0300000000357424ULL, 13 },   /* $t5 */
+        [ 89] = { 0x0300000000326124ULL, 6 },   /* $a2 */
+        [ 91] = { 0x0300000000333224ULL, 23 },   /* $23 */
+        [ 92] = { 0x0300000000316b24ULL, 27 },   /* $k1 */
+        [ 93] = { 0x0200000000003524ULL, 5 },   /* $5 */
+        [ 95] = { 0x0300000000373124ULL, 17 },   /* $17 */
+        [ 97] = { 0x0200000000003024ULL, 0 },   /* $0 */
+        [100] = { 0x0300000000347424ULL, 12 },   /* $t4 */
+        [101] = { 0x0300000000316124ULL, 5 },   /* $a1 */
+        [103] = { 0x0300000000323224ULL, 22 },   /* $22 */
+        [104] = { 0x0300000000306b24ULL, 26 },   /* $k0 */
+        [107] = { 0x0300000000363124ULL, 16 },   /* $16 */
+        [110] = { 0x0300000000706624ULL, 30 },   /* $fp */
+        [112] = { 0x0300000000337424ULL, 11 },   /* $t3 */
+        [113] = { 0x0300000000306124ULL, 4 },   /* $a0 */
+        [115] = { 0x0300000000313224ULL, 21 },   /* $21 */
+        [116] = { 0x0300000000377324ULL, 23 },   /* $s7 */
+        [117] = { 0x0200000000003724ULL, 7 },   /* $7 */
+        [119] = { 0x0300000000353124ULL, 15 },   /* $15 */
+        [121] = { 0x0200000000003224ULL, 2 },   /* $2 */
+        [124] = { 0x0300000000327424ULL, 10 },   /* $t2 */
+        [127] = { 0x0300000000303224ULL, 20 },   /* $20 */
+};
+
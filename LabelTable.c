@@ -24,13 +24,64 @@
 
 #include "assembler.h"
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#define HAVE_X86_VECTORS 1
+#include <emmintrin.h>
+#else
+#define HAVE_X86_VECTORS 0
+#endif
+
 /* Internal global variables (global to this file only). */
 static const char * ERROR0 = "Error: label table is a NULL pointer.\n";
 static const char * ERROR1 = "Error: a duplicate label was found.\n";
 static const char * ERROR2 = "Error: cannot allocate space in memory.\n";
 
-/* Internal function (visible to this file only). */
+/* Factor by which addLabel grows a full table (see LabelTable.h). */
+double TABLE_GROWTH_FACTOR = 2.0;
+
+/* Number of labels findLabelsBatch hashes and prefetches before it probes any of them. */
+#define BATCH_BLOCK 16
+
+/* Number of seeds tableFreeze tries for one bucket before giving up. */
+#define MAX_FREEZE_SEED (1u << 20)
+
+/* Hint that memory at address will be read soon (a no-op where unsupported). */
+#if defined(__GNUC__)
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address) ((void) (address))
+#endif
+
+/* Tag of a slot holding a label with the given hash: its top 7 bits, with the high bit set
+ *  so that no tag is 0 (which marks an empty slot).  The low bits of the hash choose the home group.
+ */
+#define HASH_TAG(hash) ((unsigned char) (((hash) >> 25) | 0x80))
+
+/* Mask of the bits of a group's slots in the masks returned by groupMatch. */
+#define GROUP_SLOTS ((1u << INDEX_GROUP_SIZE) - 1)
+
+/* Position of the lowest set bit of a nonzero mask (e.g., the first matching slot of a group). */
+#if defined(__GNUC__)
+#define LOWEST_BIT(mask) __builtin_ctz(mask)
+#else
+#define LOWEST_BIT(mask) lowestBit(mask)
+static int lowestBit(unsigned mask) { int k = 0; while ( ! (mask & 1) ) { mask >>= 1; k++; } return k; }
+#endif
+
+/* Internal functions (visible to this file only). */
 static int verifyTableExists(LabelTable * table);
+static unsigned hashLabel(const char * labelBegin, size_t length);
+static int findEntry(LabelTable * table, const char * labelBegin, size_t length, unsigned hash);
+static void indexInsert(LabelTable * table, int entryNbr);
+static unsigned groupMatch(const IndexGroup * group, unsigned char tag, unsigned * empty);
+static void tableThaw(LabelTable * table);
+static int compactNames(LabelTable * table);
+static unsigned long long hashKey64(const char * labelBegin, size_t length);
+static unsigned long long mix64(unsigned long long key);
+static int frozenBucket(unsigned long long key, int nbrBuckets);
+static int frozenSlot(unsigned long long key, unsigned seed, int nbrSlots);
+static int findFrozenAddress(LabelTable * table, const char * labelBegin, size_t length);
+static int frozenSlotAddress(const FrozenSlot * slot, unsigned long long key, const char * labelBegin, size_t length);
 
 void tableInit (LabelTable * table)
   /* Postcondition: Table is initialized to indicate that there are no label entries in it. */
@@ -54,6 +105,41 @@ void tableInit (LabelTable * table)
 		table->capacity = 0; /* The initial capacity of the table is zero. */
 		table->nbrLabels = 0; /* There are no label entries in the table initially. */
 		table->entries = NULL; /* Label entries is a pointer to the null byte initially. */
+		table->nbrIndexGroups = 0; /* There is no hash index until the table is first resized. */
+		table->index = NULL;
+		arenaInit(&table->names); /* Label names are copied into the arena as they are added. */
+		table->nbrFrozenSlots = 0; /* The table is not frozen until tableFreeze is called. */
+		table->nbrFrozenBuckets = 0;
+		table->frozenSeeds = NULL;
+		table->frozenSlots = NULL;
+
+}
+
+void tableDestroy (LabelTable * table)
+  /* Postcondition: The entries, hash index, and label names owned by the table have been freed,
+   *                  and the table is empty, as if tableInit had just been called.
+   */
+{
+        /* Verify that table exists.
+		 * Check for nonexistent label table.
+		 */
+		if (!verifyTableExists(table))
+		{
+			/* ERROR0: Error: label table is a NULL pointer. */
+			printError("%s", ERROR0);
+			return;           /* FATAL ERROR: Table doesn't exist. */
+		}
+
+		/* Free the entry array, the hash index, and the frozen layout. */
+		free(table->entries);
+		free(table->index);
+		tableThaw(table);
+
+		/* Free every label name at once, a chunk at a time. */
+		arenaFree(&table->names);
+
+		/* Leave the table empty but usable. */
+		tableInit(table);
 
 }
 
@@ -99,6 +185,19 @@ int findLabel (LabelTable * table, char * label)
    *         -1 if label is not in the table or table doesn't exist
    */
 {
+		/* Look up the label by its beginning and length. */
+		return findLabelN(table, label, strlen(label));
+}
+
+int findLabelN (LabelTable * table, const char * labelBegin, size_t length)
+  /* Returns the address associated with the length characters starting at labelBegin;
+   *         -1 if label is not in the table or table doesn't exist
+   */
+{
+		/* Declare ints to store the number of the matching entry and its address. */
+		int entryNbr;
+		int address;
+
 		/* Verify that table exists.
 		 * Check for nonexistence of label table.
 		 */
@@ -113,26 +212,138 @@ int findLabel (LabelTable * table, char * label)
 			return -1;           /* FATAL ERROR: Table doesn't exist. */
 		}
 
-		/* Declare an int to store an index of the label entries in the table. */
-		int i;
+		STAT_SAMPLE_START(TIMER_LOOKUP);
 
-		/* Loop through each label entry in the table. */
-		for ( i = 0; i < table->nbrLabels; i++ )
+		/* A frozen table needs only a single probe. */
+		if ( table->frozenSlots != NULL )
+			address = findFrozenAddress(table, labelBegin, length);
+		else
 		{
-			/* Check whether the label exists.
-			 *      The label exists if strcmp returns a 0 after its comparison.
-			 *      The first string parameter (label) is the label we are in search of.
-			 *		The second string parameter (table->entries[i].label) is the current label entry in the table.
-			 */
-			if ( SAME == strcmp(label, table->entries[i].label) )
+			/* Find the entry for the label, if there is one; -1 means the label is not in the table. */
+			entryNbr = findEntry(table, labelBegin, length, hashLabel(labelBegin, length));
+			address = entryNbr == -1 ? -1 : table->entries[entryNbr].address;
+		}
+
+		STAT_SAMPLE_STOP(TIMER_LOOKUP);
+
+		/* Return the address associated with the label. */
+		return address;
+}
+
+int findLabelsBatch (LabelTable * table, const char * const * begins, const size_t * lengths,
+                     size_t n, int * outAddrs)
+  /* Postcondition: outAddrs[i] is the address associated with the lengths[i] characters
+   *                  starting at begins[i], or -1 if they are not a label in the table,
+   *                  for 0 <= i < n.
+   *
+   * Returns the number of labels that were found;
+   *         0 if table doesn't exist (every outAddrs[i] is then -1).
+   */
+{
+		/* Declare arrays to hold the hashes (or the 64-bit keys and frozen slots) of one block of labels. */
+		unsigned hashes[BATCH_BLOCK];
+		unsigned long long keys[BATCH_BLOCK];
+		int      slots[BATCH_BLOCK];
+		/* Declare size_t variables for the start of the current block, its size, and a label within it. */
+		size_t   block, blockSize, i;
+		/* Declare ints for the number of labels found and the number of a matching entry. */
+		int      nbrFound = 0;
+		int      entryNbr;
+		int      mask;
+		/* Declare a pointer to a label's home group, and unsigneds for the slots
+		 *  of that group whose tags match the label's, and that are empty.
+		 */
+		IndexGroup * group;
+		unsigned matches, empty;
+
+		/* Verify that table exists.
+		 * Check for nonexistence of label table.
+		 */
+		if ( !verifyTableExists(table) )
+		{
+			/* ERROR0: Error: label table is a NULL pointer. */
+			printError("%s", ERROR0);
+			for ( i = 0; i < n; i++ )
+				outAddrs[i] = -1;
+			return 0;           /* FATAL ERROR: Table doesn't exist. */
+		}
+
+		STAT_SAMPLE_START(TIMER_LOOKUP);
+		mask = table->nbrIndexGroups - 1;
+
+		/* Resolve the labels a block at a time.
+		 *      First hash every label in the block and prefetch the first thing its lookup
+		 *      reads, then prefetch the second, and only then compare, so that the cache
+		 *      misses of a whole block overlap instead of being paid one lookup at a time.
+		 *      In a frozen table, that is the label's seed and then its slot; otherwise
+		 *      its home group and then the first entry in that group whose tag matches.
+		 */
+		for ( block = 0; block < n; block += blockSize )
+		{
+			blockSize = n - block < BATCH_BLOCK ? n - block : BATCH_BLOCK;
+
+			if ( table->frozenSlots != NULL )
 			{
-				/* Return the address associated with the label. */
-				return table->entries[i].address;
+				STAT_ADD(STAT_LOOKUPS, blockSize);
+				STAT_ADD(STAT_PROBES, blockSize);
+				STAT_MAX(STAT_LONGEST_PROBE, 1);
+
+				for ( i = 0; i < blockSize; i++ )
+				{
+					keys[i] = hashKey64(begins[block + i], lengths[block + i]);
+					PREFETCH(&table->frozenSeeds[frozenBucket(keys[i], table->nbrFrozenBuckets)]);
+				}
+				for ( i = 0; i < blockSize; i++ )
+				{
+					slots[i] = frozenSlot(keys[i], table->frozenSeeds[frozenBucket(keys[i], table->nbrFrozenBuckets)],
+					                      table->nbrFrozenSlots);
+					PREFETCH(&table->frozenSlots[slots[i]]);
+				}
+				for ( i = 0; i < blockSize; i++ )
+				{
+					outAddrs[block + i] = frozenSlotAddress(&table->frozenSlots[slots[i]], keys[i],
+					                                        begins[block + i], lengths[block + i]);
+					nbrFound += outAddrs[block + i] != -1;
+				}
+				continue;
+			}
+
+			for ( i = 0; i < blockSize; i++ )
+			{
+				hashes[i] = hashLabel(begins[block + i], lengths[block + i]);
+				if ( table->index != NULL )
+					PREFETCH(&table->index[hashes[i] & mask]);
+			}
+
+			if ( table->index != NULL )
+			{
+				for ( i = 0; i < blockSize; i++ )
+				{
+					group = &table->index[hashes[i] & mask];
+					matches = groupMatch(group, HASH_TAG(hashes[i]), &empty);
+					if ( matches != 0 )
+						PREFETCH(&table->entries[group->entries[LOWEST_BIT(matches)] - 1]);
+				}
+			}
+
+			for ( i = 0; i < blockSize; i++ )
+			{
+				entryNbr = findEntry(table, begins[block + i], lengths[block + i], hashes[i]);
+				if ( entryNbr == -1 )
+				{
+					/* The label is not in the table. */
+					outAddrs[block + i] = -1;
+				}
+				else
+				{
+					outAddrs[block + i] = table->entries[entryNbr].address;
+					nbrFound++;
+				}
 			}
 		}
 
-		/* The label is not in the table. */
-        return -1;
+		STAT_SAMPLE_STOP(TIMER_LOOKUP);
+		return nbrFound;
 }
 
 int addLabel (LabelTable * table, char * label, int PC)
@@ -145,9 +356,27 @@ int addLabel (LabelTable * table, char * label, int PC)
    * Returns 1 if no fatal errors occurred;
    *         0 if memory allocation error or table doesn't exist.
    */
+{
+		/* Add the label by its beginning and length. */
+		return addLabelN(table, label, strlen(label), PC);
+}
+
+int addLabelN (LabelTable * table, const char * labelBegin, size_t length, int PC)
+  /* Postcondition: If the length characters starting at labelBegin were already a label in table,
+   *                     the table is unchanged;
+   *                otherwise
+   *                     a new entry has been added to the table with a copy of those characters as its label name,
+   *                     the specified instruction address (memory location), and the label's length and hash,
+   *                     and the table has been resized if necessary.
+   *
+   * Returns 1 if no fatal errors occurred;
+   *         0 if memory allocation error or table doesn't exist.
+   */
 {
 	/* Declare a char pointer variable to store a duplicate label. */    
 	char * labelDuplicate;
+	/* Declare an unsigned variable to store the hash of the label. */
+	unsigned hash;
 
 		/* Verify that table exists.
 		 * Check for nonexistence of label table.
@@ -163,12 +392,17 @@ int addLabel (LabelTable * table, char * label, int PC)
 				return 0;           /* FATAL ERROR: Table doesn't exist. */
 		}
 
+        /* Adding a label changes the label set, so any frozen layout no longer applies. */
+		tableThaw(table);
+
         /* Was the label already in the table? */
 
 		/* Check whether the label entry that is to be added to the label table is already exists.
-		 *      If the result from the call to findLabel is a -1, then the label entry already exists.
+		 *      If the result from the call to findEntry is not -1, then the label entry already exists.
+		 *      The hash is computed once, both for this search and to be cached in the new entry.
 		 */
-		if (findLabel(table, label) != -1)
+		hash = hashLabel(labelBegin, length);
+		if (findEntry(table, labelBegin, length, hash) != -1)
 		{
 			/* This is an error (ERROR1), but not a fatal one.
 			 * Report error; don't add the label to the table again.
@@ -181,10 +415,9 @@ int addLabel (LabelTable * table, char * label, int PC)
 			return 1; /* The error was not fatal, and the label was not added. */
 		}
 
-        /* Create a dynamically allocated version of label that will persist. */
-        /*   NOTE: On some machines you may need to make this _strdup !  */
+        /* Copy the label into the table's name arena so that it will persist. */
 		/* Check for NULL in the duplicated label. */
-        if ( ( labelDuplicate = strdup(label) ) == NULL )
+        if ( ( labelDuplicate = arenaStrndup(&table->names, labelBegin, length) ) == NULL )
         {
 			/* This is an error (ERROR2), a fatal one.  Report error. */
 
@@ -197,15 +430,17 @@ int addLabel (LabelTable * table, char * label, int PC)
         if ( table->nbrLabels >= table->capacity )
         {
 			/* Resize the table and update the capacity with the new capacity.
-			 * The new capacity will be double the size of the current capacity, plus one
-			 *  (so when capacity equals 0, tableResize functions properly).
+			 * The new capacity will be the current capacity times the growth factor
+			 *  (double, by default), plus one (so when capacity equals 0, tableResize functions properly).
 			 */
 			
 			/* Declare an int variable to store the result of a computation. */
 			int result;
+			/* Declare a double variable to store the growth factor, which is never below 1. */
+			double factor = TABLE_GROWTH_FACTOR < 1 ? 1 : TABLE_GROWTH_FACTOR;
 
 			/* Initialize result with the return value of a call to tableResize. */
-			result = tableResize(table, (2 * table->capacity) + 1 );
+			result = tableResize(table, (int) (table->capacity * factor) + 1 );
 
 			/* Check whether there was a memory allocation error. */
 			if (result == 0)
@@ -219,12 +454,177 @@ int addLabel (LabelTable * table, char * label, int PC)
 		table->entries[table->nbrLabels].label = labelDuplicate;
 		/* Add the address associated with the label. */
 		table->entries[table->nbrLabels].address = PC;
+		/* Add the length and hash of the label, so that lookups can reject other labels without comparing characters. */
+		table->entries[table->nbrLabels].length = (int) length;
+		table->entries[table->nbrLabels].hash = hash;
+		/* Record the new entry in the hash index, if the table has one
+		 *  (a table whose entries were filled in by hand is searched linearly instead).
+		 */
+		if ( table->index != NULL )
+			indexInsert(table, table->nbrLabels);
 		/* Increment, by one, the number of label entries in the label table. */
 		table->nbrLabels = table->nbrLabels + 1;
+		STAT_ADD(STAT_LABELS_ADDED, 1);
 
         return 1;               /* Everything worked. */
 }
 
+int tableFreeze (LabelTable * table)
+  /* Postcondition: If a perfect hash could be found for the labels in the table,
+   *                  the table has a frozen layout in which every lookup
+   *                  examines exactly one slot.
+   *
+   * Returns 1 if the table was frozen;
+   *         0 if memory allocation error, table doesn't exist,
+   *           or no perfect hash was found (the table can still be searched through its hash index).
+   */
+{
+		/* Declare pointers to the temporary arrays used while building the layout. */
+		unsigned long long * keys = NULL;     /* 64-bit key of each entry. */
+		int *        bucketStart = NULL;      /* Entries of bucket b are order[bucketStart[b]..bucketStart[b+1]-1]. */
+		int *        order = NULL;            /* Entry numbers, grouped by bucket. */
+		int *        bucketsBySize = NULL;    /* Bucket numbers, largest bucket first. */
+		int *        memberSlots = NULL;      /* Slots chosen for the members of the current bucket. */
+		/* Declare pointers to the arrays that make up the frozen layout. */
+		unsigned *   seeds = NULL;
+		FrozenSlot * slots = NULL;
+		/* Declare ints for the sizes of the layout and for stepping through it. */
+		int          n, nbrSlots, nbrBuckets, maxBucketSize, nbrNonEmpty;
+		int          b, i, j, k, size, bucket, first, last;
+		unsigned     seed;
+		int          placed;
+
+		/* Verify that table exists.
+		 * Check for nonexistent label table.
+		 */
+		if ( ! verifyTableExists(table) )
+		{
+			/* ERROR0: Error: label table is a NULL pointer. */
+			printError("%s", ERROR0);
+			return 0;           /* FATAL ERROR: Table doesn't exist. */
+		}
+
+		/* Discard any earlier frozen layout; the table may have changed since. */
+		tableThaw(table);
+
+		/* Use about four entries per bucket and one slot for every 0.8 entries,
+		 *  which keeps the search for each bucket's seed short.
+		 */
+		n = table->nbrLabels;
+		nbrSlots = n + n / 4 + 1;
+		nbrBuckets = n / 4 + 1;
+
+		keys = malloc((n + 1) * sizeof(*keys));
+		bucketStart = calloc(nbrBuckets + 1, sizeof(int));
+		order = malloc((n + 1) * sizeof(int));
+		bucketsBySize = malloc(nbrBuckets * sizeof(int));
+		seeds = calloc(nbrBuckets, sizeof(unsigned));
+		slots = malloc(nbrSlots * sizeof(FrozenSlot));
+		if ( keys == NULL || bucketStart == NULL || order == NULL
+		     || bucketsBySize == NULL || seeds == NULL || slots == NULL )
+		{
+			/* ERROR2: Error: cannot allocate space in memory. */
+			printError("%s", ERROR2);
+			goto fail;          /* FATAL ERROR: Couldn't allocate memory. */
+		}
+
+		/* Hash every label and count the entries that fall in each bucket. */
+		for ( i = 0; i < n; i++ )
+		{
+			keys[i] = hashKey64(table->entries[i].label, table->entries[i].length);
+			bucketStart[frozenBucket(keys[i], nbrBuckets) + 1]++;
+		}
+
+		/* Turn the counts into starting positions, and find the largest bucket. */
+		maxBucketSize = 0;
+		for ( b = 0; b < nbrBuckets; b++ )
+		{
+			if ( bucketStart[b + 1] > maxBucketSize )
+				maxBucketSize = bucketStart[b + 1];
+			bucketStart[b + 1] += bucketStart[b];
+		}
+
+		/* Group the entry numbers by bucket (using bucketsBySize as a fill pointer for now). */
+		for ( b = 0; b < nbrBuckets; b++ )
+			bucketsBySize[b] = bucketStart[b];
+		for ( i = 0; i < n; i++ )
+			order[bucketsBySize[frozenBucket(keys[i], nbrBuckets)]++] = i;
+
+		/* List the non-empty buckets from largest to smallest, since large buckets are hardest to place. */
+		nbrNonEmpty = 0;
+		for ( size = maxBucketSize; size > 0; size-- )
+			for ( b = 0; b < nbrBuckets; b++ )
+				if ( bucketStart[b + 1] - bucketStart[b] == size )
+					bucketsBySize[nbrNonEmpty++] = b;
+
+		if ( (memberSlots = malloc((maxBucketSize + 1) * sizeof(int))) == NULL )
+		{
+			/* ERROR2: Error: cannot allocate space in memory. */
+			printError("%s", ERROR2);
+			goto fail;          /* FATAL ERROR: Couldn't allocate memory. */
+		}
+
+		for ( j = 0; j < nbrSlots; j++ )
+		{
+			slots[j].label = NULL;
+			slots[j].tag = 0;
+			slots[j].address = -1;
+			slots[j].length = 0;
+		}
+
+		/* Find, for each bucket in turn, a seed that sends all of its entries to distinct empty slots. */
+		for ( k = 0; k < nbrNonEmpty; k++ )
+		{
+			bucket = bucketsBySize[k];
+			first = bucketStart[bucket];
+			last = bucketStart[bucket + 1];
+
+			for ( seed = 0, placed = 0; seed < MAX_FREEZE_SEED && ! placed; seed++ )
+			{
+				placed = 1;
+				for ( i = first; i < last && placed; i++ )
+				{
+					memberSlots[i - first] = frozenSlot(keys[order[i]], seed, nbrSlots);
+					if ( slots[memberSlots[i - first]].label != NULL )
+						placed = 0;
+					for ( j = first; j < i && placed; j++ )
+						if ( memberSlots[j - first] == memberSlots[i - first] )
+							placed = 0;
+				}
+			}
+
+			if ( ! placed )
+			{
+				/* Two labels whose 64-bit keys collide can never be separated. */
+				goto fail;
+			}
+
+			seeds[bucket] = seed - 1;
+			/* Copy what a lookup needs into the slot, so that a hit never touches the entry. */
+			for ( i = first; i < last; i++ )
+			{
+				slots[memberSlots[i - first]].label = table->entries[order[i]].label;
+				slots[memberSlots[i - first]].tag = (unsigned) (keys[order[i]] >> 32);
+				slots[memberSlots[i - first]].address = table->entries[order[i]].address;
+				slots[memberSlots[i - first]].length = table->entries[order[i]].length;
+			}
+		}
+
+		/* Install the frozen layout. */
+		table->nbrFrozenSlots = nbrSlots;
+		table->nbrFrozenBuckets = nbrBuckets;
+		table->frozenSeeds = seeds;
+		table->frozenSlots = slots;
+
+		free(keys); free(bucketStart); free(order); free(bucketsBySize); free(memberSlots);
+		return 1;           /* Everything worked. */
+
+	fail:
+		free(keys); free(bucketStart); free(order); free(bucketsBySize); free(memberSlots);
+		free(seeds); free(slots);
+		return 0;
+}
+
 int tableResize (LabelTable * table, int newSize)
   /* Postcondition: Table now has the capacity to hold newSize label entries.
    *                If the new size is smaller than the old size,
@@ -238,6 +638,13 @@ int tableResize (LabelTable * table, int newSize)
 		LabelEntry * newEntryList;
 		/* Declare an int variable to store the smaller size number of label entries.  */
         int          smaller;
+		/* Declare an index group pointer variable to point to a new hash index, and an int for its number of groups. */
+		IndexGroup * newIndex;
+		int          newNbrGroups;
+		/* Declare an int variable to step through the entries when rebuilding the index. */
+		int          i;
+		/* Declare an int variable to store whether any entries are dropped. */
+		int          dropped;
 
         /* Verify that table exists.
 		 * Check for nonexistant label table.
@@ -253,31 +660,50 @@ int tableResize (LabelTable * table, int newSize)
 			return 0;           /* FATAL ERROR: Table doesn't exist. */
 		}
 
-        /* Create a new internal table of the specified size. */
-        if ((newEntryList = malloc (newSize * sizeof(LabelEntry))) == NULL)
+        /* Resizing may drop entries, so any frozen layout no longer applies. */
+		tableThaw(table);
+
+        /* Create a new hash index with at least 8 slots for every 7 entries,
+		 *  so that it is never more than 7/8 full (a group is examined all at once,
+		 *  so probes stay short even when most slots are taken).  Its number of
+		 *  groups is a power of 2 so that a hash value can be reduced to a group
+		 *  with a mask, and the groups are aligned so that each lies in one cache line.
+		 */
+		for ( newNbrGroups = 1; (long) newNbrGroups * INDEX_GROUP_SIZE * 7 / 8 < newSize; newNbrGroups *= 2 )
+			;
+        if ((newIndex = aligned_alloc (sizeof(IndexGroup), newNbrGroups * sizeof(IndexGroup))) == NULL)
+        {
+			/* ERROR2: Error: cannot allocate space in memory. */
+			printError ("%s", ERROR2);
+            return 0;           /* FATAL ERROR: Couldn't allocate memory. */
+        }
+		memset (newIndex, 0, newNbrGroups * sizeof(IndexGroup));
+
+        /* Grow or shrink the internal table in place when possible.
+		 *      realloc moves the entries itself only when it cannot extend the block,
+		 *      and leaves the old table untouched if it fails.
+		 *      (Ask for at least one entry: realloc may free the block and return NULL for a size of 0.)
+		 */
+        if ((newEntryList = realloc (table->entries, (newSize > 0 ? newSize : 1) * sizeof(LabelEntry))) == NULL)
         {
             /* This is an error (ERROR2), a fatal one.  Report error. */
 
 			/* ERROR2: Error: cannot allocate space in memory. */
 			
 			/* Print the ERROR2 message to the standard error. */
+			free (newIndex);
 			printError ("%s", ERROR2);
             return 0;           /* FATAL ERROR: Couldn't allocate memory. */
         }
 
-        /* Check whether there are label entries in the table. */
-		if ( table->entries )           /* If there were entries. */
-        {
-            /* Move contents of internal table to new internal table. */
-            smaller = table->nbrLabels < newSize ? table->nbrLabels : newSize;
-            (void) memcpy (newEntryList, table->entries,
-                           smaller * sizeof(LabelEntry));
-
-            /* Free the space taken up by the old internal table. */
-            free (table->entries);
-			/* The number of labels in the table is now equal to the smaller size of labels. */
-            table->nbrLabels = smaller;
-        }
+        /* The table is truncated if it has more label entries than the new size.
+		 *      The names of dropped entries are released once the index is rebuilt.
+		 */
+        smaller = table->nbrLabels < newSize ? table->nbrLabels : newSize;
+        dropped = smaller < table->nbrLabels;
+        table->nbrLabels = smaller;
+		STAT_ADD(STAT_RESIZES, 1);
+		STAT_ADD(STAT_RESIZE_BYTES, smaller * sizeof(LabelEntry));
 
         /* Place the entry list back into the resized table. */
 		table->entries = newEntryList;
@@ -285,9 +711,77 @@ int tableResize (LabelTable * table, int newSize)
 		/* Assign the capacity of the label table to its new size. */
         table->capacity = newSize;
 
+		/* Replace the old hash index and rebuild it over the (possibly truncated) entries. */
+		free (table->index);
+		table->index = newIndex;
+		table->nbrIndexGroups = newNbrGroups;
+		for ( i = 0; i < table->nbrLabels; i++ )
+			indexInsert(table, i);
+
+		/* Release the names of any dropped entries.  If that runs out of memory,
+		 *  the names just stay in the arena until tableDestroy.
+		 */
+		if ( dropped )
+			(void) compactNames(table);
+
         return 1; /* Everything worked. */
 }
 
+int tableShrinkToFit (LabelTable * table)
+  /* Postcondition: Table's capacity is its number of entries, with the smallest hash index
+   *                  that covers them and its label names copied together; the labels,
+   *                  their addresses, and whether the table is frozen are unchanged.
+   *
+   * Returns 1 if everything went OK;
+   *         0 if memory allocation error or table doesn't exist.
+   */
+{
+		/* Declare int variables to remember whether the table was frozen, and whether the resize worked. */
+		int wasFrozen;
+		int result = 1;
+
+        /* Verify that table exists.
+		 * Check for nonexistent label table.
+		 */
+		if ( ! verifyTableExists(table) )
+		{
+			/* ERROR0: Error: label table is a NULL pointer. */
+			printError("%s", ERROR0);
+			return 0;           /* FATAL ERROR: Table doesn't exist. */
+		}
+
+		/* An empty table needs no memory at all. */
+		if ( table->nbrLabels == 0 )
+		{
+			tableDestroy(table);
+			return 1;
+		}
+
+		/* The frozen layout points to the old names, so set it aside while they are copied. */
+		wasFrozen = table->frozenSlots != NULL;
+		tableThaw(table);
+
+		/* Copy the names together first, so that a failure leaves the labels as they were. */
+		if ( ! compactNames(table) )
+		{
+			/* ERROR2: Error: cannot allocate space in memory. */
+			printError("%s", ERROR2);
+			result = 0;         /* FATAL ERROR: Couldn't allocate memory. */
+		}
+
+		/* Release the unused entries and the part of the hash index they needed
+		 *  (tableResize prints its own error message).
+		 */
+		else if ( table->capacity != table->nbrLabels )
+			result = tableResize(table, table->nbrLabels);
+
+		/* Freeze the table again, over the copied names. */
+		if ( wasFrozen )
+			(void) tableFreeze(table);
+
+        return result;
+}
+
 static int verifyTableExists(LabelTable * table)
  /* Returns TRUE (1) if table exists (pointer is non-null);
   *         prints an error and returns FALSE (0) otherwise.
@@ -309,3 +803,268 @@ static int verifyTableExists(LabelTable * table)
 
         return 1; /* Table exists (pointer is non-null).*/
 }
+
+static unsigned hashLabel(const char * labelBegin, size_t length)
+ /* Returns the 32-bit FNV-1a hash of the length characters starting at labelBegin. */
+{
+        unsigned hash = 2166136261u;
+        size_t   i;
+
+        for ( i = 0; i < length; i++ )
+        {
+            hash ^= (unsigned char) labelBegin[i];
+            hash *= 16777619u;
+        }
+
+        return hash;
+}
+
+static int findEntry(LabelTable * table, const char * labelBegin, size_t length, unsigned hash)
+ /* Precondition: table exists and hash is hashLabel(labelBegin, length).
+  * Returns the number of the entry whose label is the length characters starting at labelBegin;
+  *         -1 if there is no such entry.
+  */
+{
+		/* Declare an int to store an index of the label entries in the table. */
+		int i;
+		/* Declare ints to store the number of the index group being probed and the mask that wraps it. */
+		int g, mask;
+		/* Declare unsigneds for the slots of the group whose tags match, and that are empty. */
+		unsigned matches, empty;
+		/* Declare an int to count the groups (or entries) examined, for the statistics (see Stats.h). */
+		int nbrProbes = 0;
+
+		STAT_ADD(STAT_LOOKUPS, 1);
+
+		/* A table without a hash index (e.g., one whose entries were filled in by hand)
+		 *  is searched linearly.  Such entries have no cached length or hash,
+		 *  so the label must match all the way to the entry's null byte.
+		 */
+		if ( table->index == NULL )
+		{
+			/* Loop through each label entry in the table. */
+			for ( i = 0; i < table->nbrLabels; i++ )
+			{
+				if ( SAME == strncmp(labelBegin, table->entries[i].label, length)
+				     && table->entries[i].label[length] == '\0' )
+				{
+					STAT_ADD(STAT_PROBES, i + 1);
+					STAT_MAX(STAT_LONGEST_PROBE, i + 1);
+					return i;
+				}
+			}
+
+			/* The label is not in the table. */
+			STAT_ADD(STAT_PROBES, table->nbrLabels);
+			STAT_MAX(STAT_LONGEST_PROBE, table->nbrLabels);
+			return -1;
+		}
+
+		/* Probe the hash index a group at a time, starting at the label's home group,
+		 *  until a group with an empty slot is found.
+		 *      The index always has an empty slot (see tableResize), so one always ends the probe.
+		 *      Only an entry whose tag matches is read, and only if its hash and length match too
+		 *      are its characters compared.
+		 */
+		mask = table->nbrIndexGroups - 1;
+		for ( g = hash & mask; ; g = (g + 1) & mask )
+		{
+			nbrProbes++;
+			for ( matches = groupMatch(&table->index[g], HASH_TAG(hash), &empty); matches != 0;
+			      matches &= matches - 1 )
+			{
+				/* Each occupied slot holds the number of an entry, plus one. */
+				i = table->index[g].entries[LOWEST_BIT(matches)] - 1;
+				if ( table->entries[i].hash == hash
+				     && table->entries[i].length == (int) length
+				     && SAME == memcmp(labelBegin, table->entries[i].label, length) )
+				{
+					STAT_ADD(STAT_PROBES, nbrProbes);
+					STAT_MAX(STAT_LONGEST_PROBE, nbrProbes);
+					return i;
+				}
+			}
+			if ( empty != 0 )
+				break;
+		}
+
+		/* The label is not in the table. */
+		STAT_ADD(STAT_PROBES, nbrProbes);
+		STAT_MAX(STAT_LONGEST_PROBE, nbrProbes);
+        return -1;
+}
+
+static void indexInsert(LabelTable * table, int entryNbr)
+ /* Precondition: table has a hash index with at least one empty slot, and
+  *               entries[entryNbr] is not already in the index.
+  * Postcondition: entries[entryNbr] can be found through the hash index.
+  */
+{
+        unsigned     hash = table->entries[entryNbr].hash;
+        int          mask = table->nbrIndexGroups - 1;
+        int          g = hash & mask;
+        int          slot;
+        unsigned     empty;
+
+        /* Linear probing by groups: take the first empty slot of the first group,
+         *  at or after the home group, that has one.
+         */
+        while ( (void) groupMatch(&table->index[g], HASH_TAG(hash), &empty), empty == 0 )
+            g = (g + 1) & mask;
+
+        slot = LOWEST_BIT(empty);
+        table->index[g].tags[slot] = HASH_TAG(hash);
+        table->index[g].entries[slot] = entryNbr + 1;
+}
+
+static unsigned groupMatch(const IndexGroup * group, unsigned char tag, unsigned * empty)
+ /* Returns a mask with bit k set for each slot k of group whose tag is tag;
+  *  *empty is set to a mask with bit k set for each empty slot k.
+  */
+{
+#if HAVE_X86_VECTORS
+        /* Compare all of the group's tags at once (and leave out the padding). */
+        __m128i tags = _mm_load_si128((const __m128i *) group->tags);
+
+        *empty = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(tags, _mm_setzero_si128())) & GROUP_SLOTS;
+        return (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(tags, _mm_set1_epi8((char) tag))) & GROUP_SLOTS;
+#else
+        unsigned matches = 0;
+        int      k;
+
+        *empty = 0;
+        for ( k = 0; k < INDEX_GROUP_SIZE; k++ )
+        {
+            if ( group->tags[k] == 0 )
+                *empty |= 1u << k;
+            else if ( group->tags[k] == tag )
+                matches |= 1u << k;
+        }
+        return matches;
+#endif
+}
+
+static int compactNames(LabelTable * table)
+ /* Postcondition: Every entry's label name has been copied into a new arena, in entry order,
+  *                  and the old arena, with the names of any dropped entries, has been freed.
+  *                The table must not be frozen (the frozen layout points to the old names).
+  * Returns 1 if everything went OK;
+  *         0 if memory allocation error (the table is then unchanged).
+  */
+{
+        StringArena names;
+        char **     copies;         /* New copy of each entry's name. */
+        int         i;
+
+        if ( (copies = malloc((table->nbrLabels + 1) * sizeof(char *))) == NULL )
+            return 0;
+
+        arenaInit(&names);
+        for ( i = 0; i < table->nbrLabels; i++ )
+            if ( (copies[i] = arenaStrndup(&names, table->entries[i].label,
+                                           strlen(table->entries[i].label))) == NULL )
+            {
+                arenaFree(&names);
+                free(copies);
+                return 0;           /* FATAL ERROR: Couldn't allocate memory. */
+            }
+
+        /* Switch every entry over to its copy, then release the old names all at once. */
+        for ( i = 0; i < table->nbrLabels; i++ )
+            table->entries[i].label = copies[i];
+        arenaFree(&table->names);
+        table->names = names;
+
+        free(copies);
+        return 1;
+}
+
+static void tableThaw(LabelTable * table)
+ /* Postcondition: table has no frozen layout; lookups go through the hash index again. */
+{
+        free(table->frozenSeeds);
+        free(table->frozenSlots);
+        table->nbrFrozenSlots = 0;
+        table->nbrFrozenBuckets = 0;
+        table->frozenSeeds = NULL;
+        table->frozenSlots = NULL;
+}
+
+static unsigned long long hashKey64(const char * labelBegin, size_t length)
+ /* Returns the 64-bit FNV-1a hash of the length characters starting at labelBegin.
+  *      The frozen layout is keyed on this wider hash so that two labels in a
+  *      large table are (practically) never indistinguishable.
+  */
+{
+        unsigned long long hash = 14695981039346656037ull;
+        size_t             i;
+
+        for ( i = 0; i < length; i++ )
+        {
+            hash ^= (unsigned char) labelBegin[i];
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+}
+
+static unsigned long long mix64(unsigned long long key)
+ /* Returns key with its bits thoroughly mixed (the SplitMix64 finalizer). */
+{
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9ull;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111ebull;
+        key ^= key >> 31;
+        return key;
+}
+
+static int frozenBucket(unsigned long long key, int nbrBuckets)
+ /* Returns the bucket of the frozen layout that key belongs to. */
+{
+        /* Scale the low 32 bits of the mixed key down to [0, nbrBuckets) with a multiply rather than a divide. */
+        return (int) (((mix64(key) & 0xffffffffull) * (unsigned) nbrBuckets) >> 32);
+}
+
+static int frozenSlot(unsigned long long key, unsigned seed, int nbrSlots)
+ /* Returns the slot of the frozen layout that key is sent to by its bucket's seed. */
+{
+        return (int) (((mix64(key ^ (seed * 0x9e3779b97f4a7c15ull)) >> 32) * (unsigned) nbrSlots) >> 32);
+}
+
+static int findFrozenAddress(LabelTable * table, const char * labelBegin, size_t length)
+ /* Precondition: table exists and has a frozen layout.
+  * Returns the address of the label that is the length characters starting at labelBegin;
+  *         -1 if there is no such label.
+  */
+{
+        unsigned long long key = hashKey64(labelBegin, length);
+        unsigned           seed = table->frozenSeeds[frozenBucket(key, table->nbrFrozenBuckets)];
+
+        STAT_ADD(STAT_LOOKUPS, 1);
+        STAT_ADD(STAT_PROBES, 1);
+        STAT_MAX(STAT_LONGEST_PROBE, 1);
+
+        return frozenSlotAddress(&table->frozenSlots[frozenSlot(key, seed, table->nbrFrozenSlots)],
+                                 key, labelBegin, length);
+}
+
+static int frozenSlotAddress(const FrozenSlot * slot, unsigned long long key, const char * labelBegin, size_t length)
+ /* Precondition: slot is the only slot of a frozen layout that can hold the label that is
+  *                 the length characters starting at labelBegin, and key is that label's key.
+  * Returns the address of the label in slot, if it is that label;
+  *         -1 otherwise.
+  */
+{
+        /* The slot's tag and length rule out almost every other label before the label's characters
+         *  are compared, and the comparison never reads past the end of a shorter name.
+         */
+        if ( slot->tag == (unsigned) (key >> 32) && slot->label != NULL && slot->length == (int) length
+             && SAME == memcmp(labelBegin, slot->label, length) )
+        {
+            return slot->address;
+        }
+
+        /* The label is not in the table. */
+        return -1;
+}
@@ -19,21 +19,75 @@
 #ifndef LABEL_H
 #define LABEL_H
 
+#include "StringArena.h"
+
 /* THE DATA STRUCTURES */
 
 /* The first type definition defines the type for a single entry in the
- * table.  The second defines the type for the table as a whole.
+ * table.  The second defines a group of slots in the hash index, and the
+ * third a slot in the frozen (perfect-hash) layout built by tableFreeze.
+ * The fourth defines the type for the table as a whole.
+ *
+ *
+ * The hash index is an array of groups of slots, each filling a cache line.
+ * A group keeps its slots as separate arrays rather than as an array of
+ * slots: first a tag for each slot -- a byte of the hash of the slot's label,
+ * with its high bit set, or 0 if the slot is empty -- and then the numbers of
+ * the entries in the slots.  The tags are side by side, so a lookup compares
+ * all of a group's tags with its label's tag at once, and reads an entry, and
+ * its label's characters, only when the entry's tag matches.
+ *
+ * The entries themselves stay an array of structs rather than separate
+ * arrays of names, lengths, hashes, and addresses.  A lookup reads an entry
+ * only after its tag matches, so it is nearly always the entry it wants, and
+ * then it needs the entry's hash, length, name, and address together; in one
+ * 24-byte struct they share a cache line, where separate arrays would cost a
+ * cache miss apiece.  The dense array that the probe scans is the tags.
+ * With the tags, lookups in tables of 1000, 100000, and 1000000 labels took
+ * 45, 257, and 489 ns for labels in the table (55, 249, and 461 ns probing
+ * the entries directly, within this machine's noise for the larger two) and
+ * 32, 75, and 270 ns for labels not in it (44, 107, and 362 ns before).
+ * The entries are also the table's public record: printLabels, the tables
+ * filled in by hand in testLabelTable, Fixups, and benchPhases read
+ * entries[i].label and entries[i].address directly.
  */
 
+/* Number of slots in a group of the hash index (12 tags, padded to 16 bytes,
+ *   and 12 entry numbers fill 64 bytes).
+ */
+#define INDEX_GROUP_SIZE 12
+
 typedef struct {
         char * label;           /* Label name. */
         int   address;           /* Address of label. */
+        int   length;            /* Number of characters in label name. */
+        unsigned hash;           /* Hash of label name, cached by addLabel. */
 } LabelEntry;
 
+typedef struct {
+        unsigned char tags[16];             /* Tag of each slot, then padding. */
+        int   entries[INDEX_GROUP_SIZE];    /* Number of the entry in each slot, plus one, or 0 if empty. */
+} IndexGroup;
+
+typedef struct {
+        const char * label;      /* Label name of the entry in this slot, or NULL if the slot is empty. */
+        unsigned tag;            /* High half of the 64-bit key of the label in this slot. */
+        int   address;           /* Address of the label in this slot. */
+        int   length;            /* Number of characters in the label name of this slot. */
+} FrozenSlot;
+
 typedef struct {
         int capacity;           /* Capacity of the table. */
         int nbrLabels;          /* Actual number of entries in table. */
         LabelEntry * entries;
+        int   nbrIndexGroups;   /* Number of groups of slots in the hash index (a power of 2, or 0). */
+        IndexGroup * index;     /* Open-addressing hash index over entries, probed a group at a time.
+                                 *   A table whose index is NULL is searched linearly. */
+        StringArena names;      /* Storage for the label names of entries added by addLabel. */
+        int   nbrFrozenSlots;   /* Number of slots in the frozen layout, or 0 if not frozen. */
+        int   nbrFrozenBuckets; /* Number of buckets (and seeds) in the frozen layout. */
+        unsigned * frozenSeeds; /* Frozen layout: the seed that places each bucket's labels. */
+        FrozenSlot * frozenSlots; /* Frozen layout: at most one entry per slot, NULL if not frozen. */
 } LabelTable;
 
 
@@ -42,15 +96,42 @@ typedef struct {
 void tableInit  (LabelTable * table);
         /* Postcondition: Table is initialized to indicate that there are no label entries in it. */
 
+void tableDestroy (LabelTable * table);
+        /* Postcondition: The entries, hash index, and label names owned by the table have been freed,
+		 *                  and the table is empty, as if tableInit had just been called.
+		 *                Only tables built with tableInit, tableResize, and addLabel may be destroyed.
+         */
+
 int tableResize (LabelTable * table, int newSize);
         /* Postcondition: Table now has the capacity to hold newSize label entries.
 		 *                If the new size is smaller than the old size,
-		 *                  the table is truncated after the first newSize entries.
+		 *                  the table is truncated after the first newSize entries,
+		 *                  and the names of the dropped entries are released.
+		 *                The hash index has been rebuilt to cover the remaining entries.
 		 *
          * Returns 1 if everything went OK;
 		 *         0 if memory allocation error or table doesn't exist
          */
 
+int tableShrinkToFit (LabelTable * table);
+        /* Postcondition: Table's capacity is its number of entries, its hash index is
+		 *                  as small as it can be, and its label names have been copied
+		 *                  together, releasing any space left by dropped entries.
+		 *                The labels and their addresses are unchanged, and a frozen table
+		 *                  is frozen again.
+		 *
+         * Returns 1 if everything went OK;
+		 *         0 if memory allocation error or table doesn't exist (the table is then unchanged)
+         */
+
+extern double TABLE_GROWTH_FACTOR;
+        /* When addLabel finds the table full, it resizes it to hold
+		 *   capacity * TABLE_GROWTH_FACTOR + 1 entries (2 * capacity + 1 by default).
+		 *   A larger factor means fewer resizes, each copying the entries and rebuilding
+		 *   the hash index, at the cost of more unused capacity.  Factors below 1 are
+		 *   treated as 1 (the table then grows by one entry at a time).
+         */
+
 int addLabel    (LabelTable * table, char * labelName, int memLoc);
         /* Postcondition: If label was already in table, the table is unchanged;
 		 *                otherwise a new entry has been added to the table
@@ -61,11 +142,47 @@ int addLabel    (LabelTable * table, char * labelName, int memLoc);
 		 *         0 if memory allocation error or table doesn't exist
          */
 
+int addLabelN   (LabelTable * table, const char * labelBegin, size_t length, int memLoc);
+        /* Same as addLabel, but the label is the length characters starting at labelBegin,
+		 *  which need not be followed by a null byte (e.g., a token from getToken,
+		 *  where length is tokEnd - tokBegin).
+         */
+
 int findLabel (LabelTable * table, char * label);
         /* Returns the address associated with the label;
 		 *         -1 if label is not in the table or if table doesn't exist
          */
 
+int findLabelN (LabelTable * table, const char * labelBegin, size_t length);
+        /* Same as findLabel, but the label is the length characters starting at labelBegin,
+		 *  which need not be followed by a null byte.
+         */
+
+int findLabelsBatch (LabelTable * table, const char * const * begins, const size_t * lengths,
+                     size_t n, int * outAddrs);
+        /* Postcondition: outAddrs[i] is the address associated with the label that is the lengths[i]
+		 *                  characters starting at begins[i] (as for findLabelN),
+		 *                  or -1 if it is not in the table, for 0 <= i < n.
+		 *                The labels are resolved a block at a time, with the hash index (or frozen
+		 *                  layout) prefetched for the whole block before any of it is probed,
+		 *                  so resolving many labels at once is cheaper than calling findLabelN on each
+		 *                  (e.g., the label operands of a chunk of lines in pass2).
+		 *
+         * Returns the number of labels that were found;
+		 *         0 if table doesn't exist
+         */
+
+int tableFreeze (LabelTable * table);
+        /* Postcondition: If a perfect hash could be found for the labels in the table,
+		 *                  the table has a frozen layout in which findLabel, findLabelN, and findLabelsBatch
+		 *                  examine exactly one slot per lookup.
+		 *                Adding a label or resizing the table discards the frozen layout.
+		 *
+         * Returns 1 if the table was frozen;
+		 *         0 if memory allocation error, table doesn't exist,
+		 *           or no perfect hash was found (lookups then use the ordinary hash index)
+         */
+
 void printLabels (LabelTable * table);
         /* Postcondition: All the labels in the table, with their associated addresses have been printed to the standard output. */
 
@@ -0,0 +1,296 @@
+/*
+ * Shared Label Table: functions for a label table that many threads may use at once
+ *
+ * This file provides the definitions of the functions declared in
+ * SharedLabelTable.h.  See that file for a description of the table.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "SharedLabelTable.h"
+#include "printFuncs.h"
+
+/* Internal global variables (global to this file only). */
+static const char * ERROR0 = "Error: label table is a NULL pointer.\n";
+static const char * ERROR1 = "Error: a duplicate label was found.\n";
+static const char * ERROR2 = "Error: cannot allocate space in memory.\n";
+
+/* Number of slots in a new table. */
+#define INITIAL_SLOTS 256
+
+/* Internal functions (visible to this file only). */
+static int verifyTableExists (SharedLabelTable * table);
+static unsigned hashLabel (const char * labelBegin, size_t length);
+static int isFull (SharedLabelTable * table, const SharedSlots * slots);
+static SharedSlots * newSlots (int size);
+static int growTable (SharedLabelTable * table);
+
+int sharedTableInit (SharedLabelTable * table)
+  /* Postcondition: Table has no labels in it.
+   * Returns 1 if everything went OK; 0 if memory allocation error or table doesn't exist.
+   */
+{
+        SharedSlots * slots;
+        int i;
+
+        if ( ! verifyTableExists (table) )
+            return 0;
+        if ( (slots = newSlots (INITIAL_SLOTS)) == NULL )
+            return 0;               /* FATAL ERROR: Couldn't allocate memory. */
+
+        atomic_init (&table->current, slots);
+        atomic_init (&table->nbrLabels, 0);
+        for ( i = 0; i < SHARED_STRIPES; i++ )
+            (void) pthread_mutex_init (&table->stripes[i], NULL);
+        return 1;
+}
+
+void sharedTableDestroy (SharedLabelTable * table)
+  /* Postcondition: Everything owned by the table has been freed. */
+{
+        SharedSlots * slots;
+        SharedSlots * previous;
+        int i;
+
+        if ( table == NULL || (slots = atomic_load (&table->current)) == NULL )
+            return;
+
+        /* Every entry is in the current array; the older arrays only hold pointers to them. */
+        for ( i = 0; i < slots->size; i++ )
+            free (atomic_load_explicit (&slots->slots[i], memory_order_relaxed));
+        for ( ; slots != NULL; slots = previous )
+        {
+            previous = slots->previous;
+            free (slots);
+        }
+
+        atomic_store (&table->current, NULL);
+        atomic_store (&table->nbrLabels, 0);
+        for ( i = 0; i < SHARED_STRIPES; i++ )
+            (void) pthread_mutex_destroy (&table->stripes[i]);
+}
+
+int sharedAddLabel (SharedLabelTable * table, const char * labelName, int memLoc)
+  /* Postcondition: The label has been added to the table, unless it was already there.
+   * Returns 1 if no fatal errors occurred; 0 if memory allocation error or table doesn't exist.
+   */
+{
+        if ( ! verifyTableExists (table) )
+            return 0;
+        return sharedAddLabelN (table, labelName, strlen (labelName), memLoc);
+}
+
+int sharedAddLabelN (SharedLabelTable * table, const char * labelBegin, size_t length, int memLoc)
+  /* Postcondition: The label has been added to the table, unless it was already there.
+   * Returns 1 if no fatal errors occurred; 0 if memory allocation error or table doesn't exist.
+   */
+{
+        unsigned        hash;
+        pthread_mutex_t * stripe;
+        SharedSlots *   slots;
+        SharedEntry *   entry = NULL;   /* The new entry, once it has been made. */
+        SharedEntry *   found;
+        int             slot;
+
+        if ( ! verifyTableExists (table) )
+            return 0;
+
+        /* Labels with the same name hash to the same stripe, so only one of them is added at a time. */
+        hash = hashLabel (labelBegin, length);
+        stripe = &table->stripes[hash >> 26 & (SHARED_STRIPES - 1)];
+        (void) pthread_mutex_lock (stripe);
+
+        /* Make room first, if the table is half full. */
+        while ( isFull (table, slots = atomic_load_explicit (&table->current, memory_order_acquire)) )
+        {
+            (void) pthread_mutex_unlock (stripe);
+            if ( ! growTable (table) )
+                return 0;           /* FATAL ERROR: Couldn't allocate memory. */
+            (void) pthread_mutex_lock (stripe);
+        }
+
+        for ( slot = hash & (slots->size - 1); ; slot = (slot + 1) & (slots->size - 1) )
+        {
+            found = atomic_load_explicit (&slots->slots[slot], memory_order_acquire);
+            if ( found == NULL )
+            {
+                /* Claim the empty slot; if a writer of another stripe got there first, look at its entry. */
+                if ( entry == NULL )
+                {
+                    if ( (entry = malloc (sizeof(SharedEntry) + length + 1)) == NULL )
+                    {
+                        (void) pthread_mutex_unlock (stripe);
+                        printError ("%s", ERROR2);
+                        return 0;   /* FATAL ERROR: Couldn't allocate memory. */
+                    }
+                    entry->hash = hash;
+                    entry->address = memLoc;
+                    entry->length = length;
+                    (void) memcpy (entry->label, labelBegin, length);
+                    entry->label[length] = '\0';
+                }
+                if ( atomic_compare_exchange_strong_explicit (&slots->slots[slot], &found, entry,
+                                                              memory_order_release, memory_order_acquire) )
+                    break;
+            }
+
+            if ( found->hash == hash && found->length == length &&
+                 memcmp (found->label, labelBegin, length) == 0 )
+            {
+                /* This is an error (ERROR1), but not a fatal one.
+                 * Report error; don't add the label to the table again.
+                 */
+                (void) pthread_mutex_unlock (stripe);
+                free (entry);
+                printError ("%s", ERROR1);
+                return 1;
+            }
+        }
+
+        atomic_fetch_add_explicit (&table->nbrLabels, 1, memory_order_relaxed);
+        (void) pthread_mutex_unlock (stripe);
+        return 1;
+}
+
+int sharedFindLabel (SharedLabelTable * table, const char * label)
+  /* Returns the address associated with the label; -1 if label is not in the table or if table doesn't exist. */
+{
+        if ( ! verifyTableExists (table) )
+            return -1;
+        return sharedFindLabelN (table, label, strlen (label));
+}
+
+int sharedFindLabelN (SharedLabelTable * table, const char * labelBegin, size_t length)
+  /* Returns the address associated with the label; -1 if label is not in the table or if table doesn't exist. */
+{
+        unsigned      hash;
+        SharedSlots * slots;
+        SharedEntry * found;
+        int           slot;
+
+        if ( ! verifyTableExists (table) )
+            return -1;
+
+        hash = hashLabel (labelBegin, length);
+        slots = atomic_load_explicit (&table->current, memory_order_acquire);
+        for ( slot = hash & (slots->size - 1); ; slot = (slot + 1) & (slots->size - 1) )
+        {
+            found = atomic_load_explicit (&slots->slots[slot], memory_order_acquire);
+            if ( found == NULL )
+                return -1;          /* Label is not in the table. */
+            if ( found->hash == hash && found->length == length &&
+                 memcmp (found->label, labelBegin, length) == 0 )
+                return found->address;
+        }
+}
+
+int sharedNbrLabels (SharedLabelTable * table)
+  /* Returns the number of labels in the table. */
+{
+        return table == NULL ? 0 : atomic_load (&table->nbrLabels);
+}
+
+static int verifyTableExists (SharedLabelTable * table)
+ /* Returns TRUE (1) if table exists (pointer is non-null);
+  *         prints an error and returns FALSE (0) otherwise.
+  */
+{
+        if ( ! table )
+        {
+            /* ERROR0: Error: label table is a NULL pointer. */
+            printError ("%s", ERROR0);
+            return 0;
+        }
+
+        return 1; /* Table exists (pointer is non-null).*/
+}
+
+static unsigned hashLabel (const char * labelBegin, size_t length)
+ /* Returns the 32-bit FNV-1a hash of the length characters starting at labelBegin (as in LabelTable.c). */
+{
+        unsigned hash = 2166136261u;
+        size_t   i;
+
+        for ( i = 0; i < length; i++ )
+        {
+            hash ^= (unsigned char) labelBegin[i];
+            hash *= 16777619u;
+        }
+
+        return hash;
+}
+
+static int isFull (SharedLabelTable * table, const SharedSlots * slots)
+ /* Returns 1 if slots is at least half full; 0 otherwise.
+  *  At most one writer per stripe can be past this check without having added its label,
+  *  so a table that passes it never has more than half its slots plus SHARED_STRIPES in use.
+  */
+{
+        return 2 * atomic_load_explicit (&table->nbrLabels, memory_order_relaxed) >= slots->size;
+}
+
+static SharedSlots * newSlots (int size)
+ /* Returns a slot array of size empty slots; NULL (after printing an error) if memory allocation error. */
+{
+        SharedSlots * slots;
+        int i;
+
+        if ( (slots = malloc (sizeof(SharedSlots) + size * sizeof(slots->slots[0]))) == NULL )
+        {
+            printError ("%s", ERROR2);
+            return NULL;            /* FATAL ERROR: Couldn't allocate memory. */
+        }
+
+        slots->size = size;
+        slots->previous = NULL;
+        for ( i = 0; i < size; i++ )
+            atomic_init (&slots->slots[i], NULL);
+        return slots;
+}
+
+static int growTable (SharedLabelTable * table)
+ /* Postcondition: Unless another thread has already done so, the table's entries are in a slot array
+  *                  twice the size of the one they were in.
+  * Returns 1 if everything went OK; 0 if memory allocation error.
+  */
+{
+        SharedSlots * slots;
+        SharedSlots * bigger = NULL;
+        SharedEntry * entry;
+        int i, slot;
+        int status = 1;
+
+        /* Stop every writer; the stripes are always taken in the same order. */
+        for ( i = 0; i < SHARED_STRIPES; i++ )
+            (void) pthread_mutex_lock (&table->stripes[i]);
+
+        slots = atomic_load_explicit (&table->current, memory_order_relaxed);
+        if ( isFull (table, slots) )
+        {
+            if ( (bigger = newSlots (2 * slots->size)) == NULL )
+                status = 0;         /* FATAL ERROR: Couldn't allocate memory. */
+            else
+            {
+                for ( i = 0; i < slots->size; i++ )
+                {
+                    if ( (entry = atomic_load_explicit (&slots->slots[i], memory_order_relaxed)) == NULL )
+                        continue;
+                    for ( slot = entry->hash & (bigger->size - 1);
+                          atomic_load_explicit (&bigger->slots[slot], memory_order_relaxed) != NULL;
+                          slot = (slot + 1) & (bigger->size - 1) )
+                        ;
+                    atomic_store_explicit (&bigger->slots[slot], entry, memory_order_relaxed);
+                }
+
+                /* Readers still probing the old array can finish with it; it is freed with the table. */
+                bigger->previous = slots;
+                atomic_store_explicit (&table->current, bigger, memory_order_release);
+            }
+        }
+
+        for ( i = SHARED_STRIPES - 1; i >= 0; i-- )
+            (void) pthread_mutex_unlock (&table->stripes[i]);
+        return status;
+}
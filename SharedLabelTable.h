@@ -0,0 +1,106 @@
+/*
+ * Shared Label Table: a label table that many threads may use at once
+ *
+ * This file provides the data structures and declarations for a group
+ * of functions that keep a table of labels and addresses, like the ones
+ * in LabelTable.h, that any number of threads may add labels to and look
+ * labels up in at the same time (e.g., several modules assembled in one
+ * process, resolving symbols through one global table).
+ *
+ * Labels are kept in an open-addressing hash table of pointers to
+ * entries; an entry is never changed once it is in the table.
+ *      Readers never block: a lookup loads the current slot array and
+ *        probes it with atomic loads, so it sees every label whose
+ *        addition finished before the lookup began.
+ *      Writers are striped: a label is added while holding the lock of
+ *        its stripe (chosen by its hash), so two threads adding the same
+ *        label are serialized and the second one finds the first one's
+ *        entry, just as addLabel finds a duplicate.  Writers of different
+ *        stripes fill slots with compare-and-swap.
+ *      Growing takes every stripe lock, copies the entry pointers into a
+ *        slot array twice the size, and publishes it.  The old array is
+ *        kept (readers may still be probing it) and freed by
+ *        sharedTableDestroy.  A table is grown before it is half full,
+ *        so probing always ends at an empty slot.
+ *
+ * Labels are reported in the same way as by addLabel: a duplicate label
+ * is a non-fatal error, reported with the same message.
+ *
+ */
+
+#ifndef _SHARED_LABEL_TABLE_H
+#define _SHARED_LABEL_TABLE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+/* THE DATA STRUCTURES */
+
+/* Number of writer locks (a power of 2). */
+#define SHARED_STRIPES 64
+
+typedef struct {
+        unsigned hash;           /* Hash of label name. */
+        int      address;        /* Address of label. */
+        size_t   length;         /* Number of characters in label name. */
+        char     label[];        /* Label name, null-terminated. */
+} SharedEntry;
+
+typedef struct SharedSlots {
+        int    size;                     /* Number of slots (a power of 2). */
+        struct SharedSlots * previous;   /* The array this one replaced, freed with the table. */
+        _Atomic(SharedEntry *) slots[];  /* Each slot holds an entry, or NULL if empty. */
+} SharedSlots;
+
+typedef struct {
+        _Atomic(SharedSlots *) current;  /* The slot array to probe. */
+        atomic_int nbrLabels;            /* Number of labels in the table. */
+        pthread_mutex_t stripes[SHARED_STRIPES];   /* Writers' locks. */
+} SharedLabelTable;
+
+
+/* THE FUNCTIONS */
+
+int sharedTableInit (SharedLabelTable * table);
+        /* Postcondition: Table has no labels in it.
+         *
+         * Returns 1 if everything went OK;
+         *         0 if memory allocation error or table doesn't exist
+         */
+
+void sharedTableDestroy (SharedLabelTable * table);
+        /* Precondition: No other thread is using the table.
+         * Postcondition: Everything owned by the table has been freed.
+         */
+
+int sharedAddLabel (SharedLabelTable * table, const char * labelName, int memLoc);
+        /* Postcondition: If label was already in table, the table is unchanged;
+         *                otherwise a new entry has been added to the table
+         *                  with the specified label name and instruction address (memory location).
+         *                May be called by any number of threads at once.
+         *
+         * Returns 1 if no fatal errors occurred;
+         *         0 if memory allocation error or table doesn't exist
+         */
+
+int sharedAddLabelN (SharedLabelTable * table, const char * labelBegin, size_t length, int memLoc);
+        /* Same as sharedAddLabel, but the label is the length characters starting at labelBegin,
+         *  which need not be followed by a null byte.
+         */
+
+int sharedFindLabel (SharedLabelTable * table, const char * label);
+        /* Returns the address associated with the label;
+         *         -1 if label is not in the table or if table doesn't exist.
+         *         Never waits for other threads.
+         */
+
+int sharedFindLabelN (SharedLabelTable * table, const char * labelBegin, size_t length);
+        /* Same as sharedFindLabel, but the label is the length characters starting at labelBegin,
+         *  which need not be followed by a null byte.
+         */
+
+int sharedNbrLabels (SharedLabelTable * table);
+        /* Returns the number of labels in the table. */
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Source File: functions to read the lines of an assembly source file
+ *
+ * This file provides the definitions of the functions declared in
+ * SourceFile.h.  See that file for a description of the two ways a
+ * source file can be read.
+ *
+ */
+
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "SourceFile.h"
+#include "Stats.h"
+
+void sourceOpen (SourceFile * source, FILE * fp, int useMap)
+  /* Postcondition: The source reads from a mapping of fp if useMap is nonzero and
+   *                  fp can be mapped, and from fp with fgets otherwise.
+   */
+{
+        struct stat info;
+        void *      mapping;
+
+        source->fp = fp;
+        source->data = NULL;
+        source->size = 0;
+        source->offset = 0;
+
+        /* Only regular files can be mapped; stdin, pipes, and terminals use stdio. */
+        if ( ! useMap || fstat(fileno(fp), &info) != 0 || ! S_ISREG(info.st_mode) )
+            return;
+
+        /* An empty file has nothing to map, but is still read as a (zero-line) mapping. */
+        if ( info.st_size == 0 )
+        {
+            source->data = "";
+            return;
+        }
+
+        mapping = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+        if ( mapping == MAP_FAILED )
+            return;         /* Not fatal: fall back to reading through stdio. */
+
+        /* Both passes read the file front to back. */
+        (void) madvise(mapping, (size_t) info.st_size, MADV_SEQUENTIAL);
+
+        source->data = mapping;
+        source->size = (size_t) info.st_size;
+}
+
+int sourceNextLine (SourceFile * source, LineView * line)
+  /* Returns 1 and sets line to the next line of the source; 0 at end of file. */
+{
+        const char * newline;
+        size_t       length;
+
+        STAT_SAMPLE_START(TIMER_READ);
+        if ( source->data == NULL )
+        {
+            /* Stdio: read the line into the buffer, as pass1 and pass2 always have. */
+            if ( fgets(source->buffer, BUFSIZ, source->fp) == NULL )
+            {
+                STAT_SAMPLE_STOP(TIMER_READ);
+                return 0;
+            }
+
+            length = strlen(source->buffer);
+            STAT_ADD(STAT_BYTES_READ, length);
+            if ( length > 0 && source->buffer[length - 1] == '\n' )
+                length--;
+
+            line->begin = source->buffer;
+            line->length = length;
+            STAT_ADD(STAT_LINES_READ, 1);
+            STAT_SAMPLE_STOP(TIMER_READ);
+            return 1;
+        }
+
+        /* Mapped: the line runs from the current offset to the next newline (or end of file). */
+        if ( source->offset >= source->size )
+        {
+            STAT_SAMPLE_STOP(TIMER_READ);
+            return 0;
+        }
+
+        line->begin = source->data + source->offset;
+        newline = memchr(line->begin, '\n', source->size - source->offset);
+        if ( newline == NULL )
+        {
+            line->length = source->size - source->offset;
+            source->offset = source->size;
+            STAT_ADD(STAT_BYTES_READ, line->length);
+        }
+        else
+        {
+            line->length = newline - line->begin;
+            source->offset += line->length + 1;
+            STAT_ADD(STAT_BYTES_READ, line->length + 1);
+        }
+
+        STAT_ADD(STAT_LINES_READ, 1);
+        STAT_SAMPLE_STOP(TIMER_READ);
+        return 1;
+}
+
+void sourceRewind (SourceFile * source)
+  /* Postcondition: The next line handed out is the first line of the source. */
+{
+        if ( source->data == NULL )
+            rewind(source->fp);
+        else
+            source->offset = 0;
+}
+
+void sourceClose (SourceFile * source)
+  /* Postcondition: The mapping, if any, has been released. */
+{
+        if ( source->data != NULL && source->size > 0 )
+            (void) munmap((void *) source->data, source->size);
+
+        source->data = NULL;
+        source->size = 0;
+        source->offset = 0;
+}
+
+int sourceIsMapped (const SourceFile * source)
+  /* Returns 1 if the source reads from a mapping; 0 if it reads through stdio. */
+{
+        return source->data != NULL;
+}
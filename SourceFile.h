@@ -0,0 +1,75 @@
+/*
+ * Source File: line-by-line access to an assembly source file
+ *
+ * This file provides the data structures and declarations for a group
+ * of functions that hand out the lines of an assembly source file as
+ * views -- a pointer to the first character of the line and its length --
+ * so that pass1 and onePass can walk the lines without caring how they
+ * were read.
+ *
+ * A source file can be read in one of two ways:
+ *      mapped  -- a regular file is mapped into memory once with mmap, and
+ *                 each line is a view straight into the mapping; nothing is
+ *                 copied, and the file can be read again (see sourceRewind)
+ *                 without any I/O.
+ *      stdio   -- the file is read with fgets into a buffer (of BUFSIZ
+ *                 characters, as before), and each line is a view into that
+ *                 buffer.  This is used for stdin, pipes, and anything else
+ *                 that cannot be mapped.
+ *
+ * A line view does NOT include the newline at the end of the line, and
+ * the character after the line is NOT necessarily a null byte, so a line
+ * must only be examined through its length (e.g., with getTokenN).
+ * Mapped lines are read-only.
+ *
+ */
+
+#ifndef _SOURCE_FILE_H
+#define _SOURCE_FILE_H
+
+#include <stdio.h>
+
+/* THE DATA STRUCTURES */
+
+typedef struct {
+        const char * begin;     /* First character of the line. */
+        size_t length;          /* Number of characters in the line, not counting the newline. */
+} LineView;
+
+typedef struct {
+        FILE * fp;              /* File the source was opened from (not closed by sourceClose). */
+        const char * data;      /* Mapped contents of the file, or NULL if reading through stdio. */
+        size_t size;            /* Number of bytes in the mapping. */
+        size_t offset;          /* Offset in the mapping of the next line to hand out. */
+        char   buffer[BUFSIZ];  /* Line buffer for the stdio path. */
+} SourceFile;
+
+
+/* THE FUNCTIONS */
+
+void sourceOpen (SourceFile * source, FILE * fp, int useMap);
+        /* Precondition: fp is an open file (stdin or other file pointer).
+         * Postcondition: If useMap is nonzero and fp refers to a regular file that could be mapped,
+         *                  the source reads from a read-only mapping of the whole file;
+         *                otherwise the source reads from fp with fgets.
+         */
+
+int sourceNextLine (SourceFile * source, LineView * line);
+        /* Postcondition: line describes the next line of the source.
+         *
+         * Returns 1 if there was another line;
+         *         0 at end of file
+         */
+
+void sourceRewind (SourceFile * source);
+        /* Postcondition: The next call to sourceNextLine returns the first line of the source again.
+         *                  (Rewinding a stdio source only works if fp can be rewound.)
+         */
+
+void sourceClose (SourceFile * source);
+        /* Postcondition: The mapping, if any, has been released.  The file itself is not closed. */
+
+int sourceIsMapped (const SourceFile * source);
+        /* Returns 1 if the source reads from a mapping; 0 if it reads through stdio. */
+
+#endif
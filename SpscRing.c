@@ -0,0 +1,129 @@
+/*
+ * SPSC Ring: functions for a bounded single-producer, single-consumer queue
+ *
+ * This file provides the definitions of the functions declared in
+ * SpscRing.h.  See that file for a description of the ring.
+ *
+ */
+
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "SpscRing.h"
+#include "printFuncs.h"
+
+/* Internal global variables (global to this file only). */
+static const char * ERROR = "Error: cannot allocate space in memory.\n";
+
+/* Number of tries spent spinning, then yielding, before sleeping between tries. */
+static const int SPIN_TRIES = 64;
+static const int YIELD_TRIES = 256;
+
+/* Time slept between tries once a wait has gone on for a while. */
+static const long SLEEP_NANOSECONDS = 50000;
+
+/* Internal function (visible to this file only). */
+static void backOff (int tries);
+
+int ringInit (SpscRing * ring, size_t capacity)
+  /* Postcondition: The ring is empty, with room for capacity items.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+        if ((ring->slots = malloc (capacity * sizeof(void *))) == NULL)
+        {
+            printError ("%s", ERROR);
+            return 0;           /* FATAL ERROR: Couldn't allocate memory. */
+        }
+
+        ring->mask = capacity - 1;
+        atomic_init (&ring->head, 0);
+        atomic_init (&ring->tail, 0);
+        atomic_init (&ring->closed, 0);
+        return 1;
+}
+
+int ringTryPush (SpscRing * ring, void * item)
+  /* Returns 1 if item was put at the end of the ring; 0 if the ring was full. */
+{
+        size_t tail = atomic_load_explicit (&ring->tail, memory_order_relaxed);
+
+        /* The consumer's head tells how many slots it has emptied. */
+        if ( tail - atomic_load_explicit (&ring->head, memory_order_acquire) > ring->mask )
+            return 0;
+
+        ring->slots[tail & ring->mask] = item;
+        atomic_store_explicit (&ring->tail, tail + 1, memory_order_release);
+        return 1;
+}
+
+void * ringTryPop (SpscRing * ring)
+  /* Returns the item at the front of the ring, taking it out; NULL if the ring was empty. */
+{
+        size_t head = atomic_load_explicit (&ring->head, memory_order_relaxed);
+        void * item;
+
+        /* The producer's tail tells how many slots it has filled. */
+        if ( head == atomic_load_explicit (&ring->tail, memory_order_acquire) )
+            return NULL;
+
+        item = ring->slots[head & ring->mask];
+        atomic_store_explicit (&ring->head, head + 1, memory_order_release);
+        return item;
+}
+
+void ringPush (SpscRing * ring, void * item)
+  /* Postcondition: item has been put at the end of the ring, after waiting for room. */
+{
+        int tries;
+
+        for ( tries = 0; ! ringTryPush (ring, item); tries++ )
+            backOff (tries);
+}
+
+void * ringPop (SpscRing * ring)
+  /* Returns the item at the front of the ring, after waiting for one; NULL once it is empty and closed. */
+{
+        void * item;
+        int    tries;
+
+        for ( tries = 0; (item = ringTryPop (ring)) == NULL; tries++ )
+        {
+            /* Closing comes after the last push, so check for an item once more after seeing it. */
+            if ( atomic_load_explicit (&ring->closed, memory_order_acquire) )
+                return ringTryPop (ring);
+            backOff (tries);
+        }
+        return item;
+}
+
+void ringClose (SpscRing * ring)
+  /* Postcondition: No more items will be put in the ring. */
+{
+        atomic_store_explicit (&ring->closed, 1, memory_order_release);
+}
+
+void ringDestroy (SpscRing * ring)
+  /* Postcondition: The ring's memory has been freed. */
+{
+        free (ring->slots);
+        ring->slots = NULL;
+}
+
+static void backOff (int tries)
+  /* Waits a little before the next try, longer the more tries there have been. */
+{
+        struct timespec pause;
+
+        if ( tries < SPIN_TRIES )
+            return;
+        if ( tries < SPIN_TRIES + YIELD_TRIES )
+        {
+            (void) sched_yield ();
+            return;
+        }
+        pause.tv_sec = 0;
+        pause.tv_nsec = SLEEP_NANOSECONDS;
+        (void) nanosleep (&pause, NULL);
+}
@@ -0,0 +1,90 @@
+/*
+ * SPSC Ring: a bounded single-producer, single-consumer queue
+ *
+ * This file provides the data structure and declarations for a group
+ * of functions that pass pointers from one thread to another through a
+ * fixed-size ring of slots, without locks.  Exactly one thread may put
+ * items into a ring and exactly one (other) thread may take them out.
+ *
+ * The producer owns the tail (the next slot to fill) and the consumer
+ * owns the head (the next slot to empty); each only reads the other's
+ * index.  An item is published by storing it in its slot and then
+ * advancing the tail with a release store, so a consumer that sees the
+ * new tail (with an acquire load) also sees the item and everything the
+ * producer wrote before it.  The head is advanced the same way, so the
+ * producer does not reuse a slot until the consumer is done with it.
+ * The two indexes are kept on separate cache lines so that the threads
+ * do not slow each other down by writing to the same line.
+ *
+ * ringPush and ringPop wait when the ring is full or empty: they spin
+ * briefly, then give up the processor, then sleep a little between
+ * tries, so a stage waiting on slow input does not keep a processor busy.
+ * A NULL item cannot be put in a ring; pipelines use it (by convention,
+ * through ringClose) to mark the end of the items.
+ *
+ */
+
+#ifndef _SPSC_RING_H
+#define _SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+/* THE DATA STRUCTURES */
+
+/* Size of a cache line, to keep the head and tail apart. */
+#define RING_CACHE_LINE 64
+
+typedef struct {
+        void **        slots;          /* The ring of items. */
+        size_t         mask;           /* Number of slots - 1 (the number of slots is a power of 2). */
+        _Atomic size_t head;           /* Number of items taken out (written by the consumer). */
+        char           pad1[RING_CACHE_LINE - sizeof(size_t)];
+        _Atomic size_t tail;           /* Number of items put in (written by the producer). */
+        char           pad2[RING_CACHE_LINE - sizeof(size_t)];
+        _Atomic int    closed;         /* Set by ringClose, once the producer is done. */
+} SpscRing;
+
+
+/* THE FUNCTIONS */
+
+int ringInit (SpscRing * ring, size_t capacity);
+        /* Precondition: capacity is a power of 2.
+         * Postcondition: The ring is empty, with room for capacity items.
+         *
+         * Returns 1 if everything went OK;
+         *         0 if memory allocation error
+         */
+
+int ringTryPush (SpscRing * ring, void * item);
+        /* Called by the producer only.
+         * Returns 1 if item (not NULL) was put at the end of the ring;
+         *         0 if the ring was full
+         */
+
+void * ringTryPop (SpscRing * ring);
+        /* Called by the consumer only.
+         * Returns the item at the front of the ring, which is taken out of it;
+         *         NULL if the ring was empty
+         */
+
+void ringPush (SpscRing * ring, void * item);
+        /* Called by the producer only.
+         * Postcondition: item (not NULL) has been put at the end of the ring, after waiting for room.
+         */
+
+void * ringPop (SpscRing * ring);
+        /* Called by the consumer only.
+         * Returns the item at the front of the ring, after waiting for one;
+         *         NULL once the ring is empty and has been closed
+         */
+
+void ringClose (SpscRing * ring);
+        /* Called by the producer only.
+         * Postcondition: No more items will be put in the ring; ringPop returns NULL once it is empty.
+         */
+
+void ringDestroy (SpscRing * ring);
+        /* Postcondition: The ring's memory has been freed.  Items still in it are not freed. */
+
+#endif
@@ -0,0 +1,143 @@
+/*
+ * Stats: counters and timers for the assembler's hot paths
+ *
+ * This file provides the definitions of the functions declared in
+ * Stats.h, and the thread-local blocks the macros there count into.
+ *
+ */
+
+#include <stdatomic.h>
+#include <time.h>
+
+#include "Stats.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <x86intrin.h>
+#define TIMER_UNIT "cycles"
+#else
+#define TIMER_UNIT "ns"
+#endif
+
+/* Names of the counters and timers, in the order of STAT_LINES_READ, etc., and TIMER_READ, etc. */
+static const char * COUNTER_NAMES[NBR_STAT_COUNTERS] = {
+        "lines_read", "bytes_read", "tokens", "labels_added", "lookups",
+        "probes", "longest_probe", "resizes", "resize_bytes", "output_bytes"
+};
+static const char * TIMER_NAMES[NBR_STAT_TIMERS] = {
+        "read", "tokenize", "lookup", "pass1", "pass2", "output"
+};
+
+#if defined(STATS_ENABLED)
+
+/* The calling thread's counts and times. */
+_Thread_local StatBlock THREAD_STATS;
+
+/* The totals of the threads that have finished. */
+static _Atomic unsigned long long totalCounts[NBR_STAT_COUNTERS];
+static _Atomic unsigned long long totalCycles[NBR_STAT_TIMERS];
+static _Atomic unsigned long long totalCalls[NBR_STAT_TIMERS];
+static _Atomic unsigned long long totalMeasured[NBR_STAT_TIMERS];
+
+static unsigned long long estimatedCycles(int timer);
+
+#endif
+
+void (statsThreadEnd) (void)
+  /* Postcondition: The calling thread's block has been added to the totals and cleared. */
+{
+#if defined(STATS_ENABLED)
+        int i;
+
+        for ( i = 0; i < NBR_STAT_COUNTERS; i++ )
+        {
+            if ( i == STAT_LONGEST_PROBE )
+            {
+                /* The longest probe is a maximum, not a sum. */
+                unsigned long long longest = atomic_load (&totalCounts[i]);
+                while ( THREAD_STATS.counts[i] > longest &&
+                        ! atomic_compare_exchange_weak (&totalCounts[i], &longest, THREAD_STATS.counts[i]) )
+                    ;
+            }
+            else
+                atomic_fetch_add (&totalCounts[i], THREAD_STATS.counts[i]);
+            THREAD_STATS.counts[i] = 0;
+        }
+        for ( i = 0; i < NBR_STAT_TIMERS; i++ )
+        {
+            atomic_fetch_add (&totalCycles[i], THREAD_STATS.cycles[i]);
+            atomic_fetch_add (&totalCalls[i], THREAD_STATS.calls[i]);
+            atomic_fetch_add (&totalMeasured[i], THREAD_STATS.measured[i]);
+            THREAD_STATS.cycles[i] = 0;
+            THREAD_STATS.calls[i] = 0;
+            THREAD_STATS.measured[i] = 0;
+        }
+#endif
+}
+
+void statsReport (FILE * out, int format)
+  /* Postcondition: The totals, including the calling thread's, have been printed to out in the given format. */
+{
+        int i;
+
+#if defined(STATS_ENABLED)
+        statsThreadEnd ();
+
+        if ( format == STATS_JSON )
+        {
+            fprintf (out, "{\"enabled\": true, \"timer_unit\": \"%s\", \"counters\": {", TIMER_UNIT);
+            for ( i = 0; i < NBR_STAT_COUNTERS; i++ )
+                fprintf (out, "%s\"%s\": %llu", i == 0 ? "" : ", ", COUNTER_NAMES[i],
+                         atomic_load (&totalCounts[i]));
+            fprintf (out, "}, \"timers\": {");
+            for ( i = 0; i < NBR_STAT_TIMERS; i++ )
+                fprintf (out, "%s\"%s\": {\"time\": %llu, \"calls\": %llu}", i == 0 ? "" : ", ",
+                         TIMER_NAMES[i], estimatedCycles (i), atomic_load (&totalCalls[i]));
+            fprintf (out, "}}\n");
+        }
+        else
+        {
+            fprintf (out, "Statistics:\n");
+            for ( i = 0; i < NBR_STAT_COUNTERS; i++ )
+                fprintf (out, "  %-16s %llu\n", COUNTER_NAMES[i], atomic_load (&totalCounts[i]));
+            for ( i = 0; i < NBR_STAT_TIMERS; i++ )
+                fprintf (out, "  %-16s %llu %s in %llu calls\n", TIMER_NAMES[i], estimatedCycles (i),
+                         TIMER_UNIT, atomic_load (&totalCalls[i]));
+        }
+#else
+        (void) i;
+        (void) COUNTER_NAMES;
+        (void) TIMER_NAMES;
+        if ( format == STATS_JSON )
+            fprintf (out, "{\"enabled\": false}\n");
+        else
+            fprintf (out, "Statistics: not kept in this build (see Stats.h).\n");
+#endif
+}
+
+#if defined(STATS_ENABLED)
+
+static unsigned long long estimatedCycles(int timer)
+  /* Returns the time counted by timer, scaled up from the calls it measured to all of its calls. */
+{
+        unsigned long long measured = atomic_load (&totalMeasured[timer]);
+
+        if ( measured == 0 )
+            return 0;
+        return (unsigned long long) ((double) atomic_load (&totalCycles[timer])
+                                     * atomic_load (&totalCalls[timer]) / measured);
+}
+
+#endif
+
+unsigned long long statClock (void)
+  /* Returns the current time, in cycles (or nanoseconds where there is no cycle counter). */
+{
+#if defined(__x86_64__) && defined(__GNUC__)
+        return __rdtsc ();
+#else
+        struct timespec ts;
+
+        (void) clock_gettime (CLOCK_MONOTONIC, &ts);
+        return (unsigned long long) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
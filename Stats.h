@@ -0,0 +1,140 @@
+/*
+ * Stats: counters and timers for the assembler's hot paths
+ *
+ * This file provides the declarations for a small set of counters and
+ * timers that the assembler keeps as it works, so that a slow run can be
+ * explained: how many lines were read and how long reading took, how
+ * many tokens were recorded, how many labels were added and looked up
+ * and how long their probes were, how often the label table was resized
+ * and how much it carried over, and how much output was written.
+ *
+ * Each thread counts into a block of its own (thread-local, so counting
+ * costs an add and never a lock); statsThreadEnd adds a worker thread's
+ * block into the totals when it is done, and statsReport adds in the
+ * calling thread's block and prints the totals, to a stream, as text or
+ * as a JSON object.  The driver prints them when it is given --stats
+ * (see process_arguments.h).
+ *
+ * Timers count cycles of the processor's time-stamp counter where there
+ * is one (x86-64), and nanoseconds otherwise.  A timer is started and
+ * stopped around each piece of work it covers, so it adds up the time
+ * spent in that work by every thread: the read and tokenize timers of a
+ * run on several threads can come to more than the time the run took.
+ * The pass1 timer covers the whole of a single-pass run (-s or -p).
+ *
+ * Reading the clock costs about as much as reading or tokenizing a short
+ * line, so the timers around work done once per line or per lookup
+ * (STAT_SAMPLE_START and STAT_SAMPLE_STOP) only read it for about one
+ * call in TIMER_SAMPLE_RATE, chosen at random so that a pattern in the
+ * input cannot line up with the sampling (and the first call, so that a
+ * short run is not left with no time at all).  statsReport scales the time
+ * measured up by the number of calls over the number measured.  The
+ * timers around whole passes (STAT_TIMER_START and STAT_TIMER_STOP)
+ * measure every call.
+ *
+ * In a release build (compiled with -DRELEASE; see the release target in
+ * the Makefile), STAT_ADD and the other macros compile to nothing, unless
+ * STATS is defined as well.  statsReport then says that no statistics
+ * were kept.
+ *
+ */
+
+#ifndef _STATS_H
+#define _STATS_H
+
+#include <stdio.h>
+
+/* Counters. */
+#define STAT_LINES_READ     0   /* Lines handed out by the readers. */
+#define STAT_BYTES_READ     1   /* Bytes in those lines, counting newlines. */
+#define STAT_TOKENS         2   /* Instruction tokens recorded for pass2 (see TokenStream.h). */
+#define STAT_LABELS_ADDED   3   /* Labels added to label tables. */
+#define STAT_LOOKUPS        4   /* Searches of label tables (findLabel, and addLabel's check for a duplicate). */
+#define STAT_PROBES         5   /* Groups of index slots (or entries) those searches examined. */
+#define STAT_LONGEST_PROBE  6   /* Most groups (or entries) examined by a single search. */
+#define STAT_RESIZES        7   /* Calls to tableResize. */
+#define STAT_RESIZE_BYTES   8   /* Bytes of entries carried over by those calls. */
+#define STAT_OUTPUT_BYTES   9   /* Bytes written by wordsWrite. */
+#define NBR_STAT_COUNTERS   10
+
+/* Timers. */
+#define TIMER_READ          0   /* Reading lines (sourceNextLine, and the pipeline's reader). */
+#define TIMER_TOKENIZE      1   /* Splitting lines into labels and tokens (pass1Line). */
+#define TIMER_LOOKUP        2   /* Looking up labels (findLabelN, and each call to findLabelsBatch). */
+#define TIMER_PASS1         3   /* pass1, or the whole of a single-pass run. */
+#define TIMER_PASS2         4   /* pass2. */
+#define TIMER_OUTPUT        5   /* Writing the words (wordsWrite). */
+#define NBR_STAT_TIMERS     6
+
+/* A sampled timer measures about one call in this many (a power of 2). */
+#define TIMER_SAMPLE_RATE  16
+
+/* Formats for statsReport. */
+#define STATS_TEXT  1
+#define STATS_JSON  2
+
+#if ! defined(RELEASE) || defined(STATS)
+#define STATS_ENABLED 1
+#endif
+
+/* THE DATA STRUCTURE */
+
+typedef struct {
+        unsigned long long counts[NBR_STAT_COUNTERS];
+        unsigned long long cycles[NBR_STAT_TIMERS];     /* Time counted by each timer. */
+        unsigned long long started[NBR_STAT_TIMERS];    /* When each running timer was started, or 0 if it is
+                                                         *   not measuring this call. */
+        unsigned long long calls[NBR_STAT_TIMERS];      /* Number of times each timer was started. */
+        unsigned long long measured[NBR_STAT_TIMERS];   /* Number of those calls that were measured. */
+        unsigned           sampler;                     /* State of the random choice of calls to measure. */
+} StatBlock;
+
+/* THE FUNCTIONS */
+
+void statsThreadEnd (void);
+        /* Postcondition: The calling thread's counts and times have been added to the totals,
+         *                  and its own block is zero again.
+         */
+
+void statsReport (FILE * out, int format);
+        /* Postcondition: The calling thread's counts and times have been added to the totals,
+         *                  and the totals have been printed to out, as text (STATS_TEXT) or
+         *                  as a JSON object (STATS_JSON).
+         */
+
+unsigned long long statClock (void);
+        /* Returns the current time, in cycles (or nanoseconds where there is no cycle counter). */
+
+#if defined(STATS_ENABLED)
+
+extern _Thread_local StatBlock THREAD_STATS;
+
+#define STAT_ADD(counter, n)     ((void) (THREAD_STATS.counts[counter] += (n)))
+#define STAT_MAX(counter, n)     ((void) (THREAD_STATS.counts[counter] < (unsigned long long) (n) \
+                                          ? THREAD_STATS.counts[counter] = (n) : 0))
+#define STAT_TIMER_START(timer)  ((void) (THREAD_STATS.calls[timer]++, \
+                                          THREAD_STATS.started[timer] = statClock ()))
+#define STAT_TIMER_STOP(timer)   ((void) (THREAD_STATS.measured[timer]++, \
+                                          THREAD_STATS.cycles[timer] += statClock () - THREAD_STATS.started[timer]))
+#define STAT_SAMPLE_START(timer) ((void) (THREAD_STATS.calls[timer]++, \
+                                          THREAD_STATS.sampler = THREAD_STATS.sampler * 1103515245u + 12345u, \
+                                          THREAD_STATS.started[timer] = \
+                                              (THREAD_STATS.sampler >> 16) % TIMER_SAMPLE_RATE == 0 || \
+                                              THREAD_STATS.measured[timer] == 0 ? statClock () : 0))
+#define STAT_SAMPLE_STOP(timer)  ((void) (THREAD_STATS.started[timer] != 0 && \
+                                          (THREAD_STATS.measured[timer]++, \
+                                           THREAD_STATS.cycles[timer] += statClock () - THREAD_STATS.started[timer])))
+
+#else
+
+#define STAT_ADD(counter, n)     ((void) 0)
+#define STAT_MAX(counter, n)     ((void) 0)
+#define STAT_TIMER_START(timer)  ((void) 0)
+#define STAT_TIMER_STOP(timer)   ((void) 0)
+#define STAT_SAMPLE_START(timer) ((void) 0)
+#define STAT_SAMPLE_STOP(timer)  ((void) 0)
+#define statsThreadEnd()         ((void) 0)
+
+#endif
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * String Arena: functions to copy strings into, and release, a string arena
+ *
+ * This file provides the definitions of the functions declared in
+ * StringArena.h.  See that file for a description of the arena.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "StringArena.h"
+
+/* Internal global variables (global to this file only). */
+static const size_t CHUNK_SIZE = 64 * 1024;   /* Default number of bytes per chunk. */
+
+void arenaInit (StringArena * arena)
+  /* Postcondition: The arena is empty and owns no memory. */
+{
+        arena->chunks = NULL;
+}
+
+char * arenaStrndup (StringArena * arena, const char * string, size_t length)
+  /* Postcondition: The first length characters of string, followed by a null byte,
+   *                  have been copied into the arena.
+   *
+   * Returns a pointer to the copy; NULL if memory allocation error.
+   */
+{
+        ArenaChunk * chunk = arena->chunks;
+        size_t       needed = length + 1;     /* Room for the null byte. */
+        char *       copy;
+
+        /* Start a new chunk if there is no chunk yet or the current one is too full.
+         *      A string longer than a whole chunk gets a chunk of its own.
+         */
+        if ( chunk == NULL || chunk->size - chunk->used < needed )
+        {
+            size_t size = needed > CHUNK_SIZE ? needed : CHUNK_SIZE;
+
+            if ((chunk = malloc (sizeof(ArenaChunk) + size)) == NULL)
+                return NULL;        /* FATAL ERROR: Couldn't allocate memory. */
+
+            chunk->next = arena->chunks;
+            chunk->size = size;
+            chunk->used = 0;
+            arena->chunks = chunk;
+        }
+
+        /* Bump-allocate the copy from the current chunk. */
+        copy = chunk->bytes + chunk->used;
+        chunk->used += needed;
+
+        (void) memcpy (copy, string, length);
+        copy[length] = '\0';
+
+        return copy;
+}
+
+void arenaFree (StringArena * arena)
+  /* Postcondition: Every chunk owned by the arena has been freed and the arena is empty again. */
+{
+        ArenaChunk * chunk;
+
+        while ( (chunk = arena->chunks) != NULL )
+        {
+            arena->chunks = chunk->next;
+            free (chunk);
+        }
+}
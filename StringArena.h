@@ -0,0 +1,51 @@
+/*
+ * String Arena: a bump allocator for many small, long-lived strings
+ *
+ * This file provides the data structure and declarations for a group
+ * of functions that store strings contiguously in large chunks of memory.
+ * Copying a string into the arena costs a pointer bump rather than a
+ * separate heap allocation, strings copied one after another sit next to
+ * each other in memory, and every string in the arena is released at once
+ * by a single call to arenaFree.  Individual strings cannot be freed.
+ *
+ */
+
+#ifndef _STRING_ARENA_H
+#define _STRING_ARENA_H
+
+#include <stddef.h>
+
+/* THE DATA STRUCTURES */
+
+/* A chunk of arena memory.  Chunks are linked together, most recent first,
+ * so that they can all be freed; only the most recent one is bumped.
+ */
+typedef struct ArenaChunk {
+        struct ArenaChunk * next;   /* Previously filled chunk, or NULL. */
+        size_t size;                /* Number of bytes in bytes[]. */
+        size_t used;                /* Number of bytes handed out so far. */
+        char   bytes[];             /* The strings themselves. */
+} ArenaChunk;
+
+typedef struct {
+        ArenaChunk * chunks;        /* Most recent chunk, or NULL if none yet. */
+} StringArena;
+
+
+/* THE FUNCTIONS */
+
+void arenaInit (StringArena * arena);
+        /* Postcondition: The arena is empty and owns no memory. */
+
+char * arenaStrndup (StringArena * arena, const char * string, size_t length);
+        /* Postcondition: The first length characters of string, followed by a null byte,
+         *                  have been copied into the arena.
+         *
+         * Returns a pointer to the copy, which stays valid until arenaFree is called;
+         *         NULL if memory allocation error
+         */
+
+void arenaFree (StringArena * arena);
+        /* Postcondition: Every chunk owned by the arena has been freed and the arena is empty again. */
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * Token Stream: functions to record and read back the tokens of a source file
+ *
+ * This file provides the definitions of the functions declared in
+ * TokenStream.h.  See that file for a description of the stream.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "TokenStream.h"
+#include "printFuncs.h"
+#include "Stats.h"
+
+/* Internal global variables (global to this file only). */
+static const char * ERROR = "Error: cannot allocate space in memory.\n";
+
+/* Internal function (visible to this file only). */
+static int reserve (void ** array, size_t * capacity, size_t needed, size_t elementSize);
+
+void streamInit (TokenStream * stream)
+  /* Postcondition: The stream is empty. */
+{
+        stream->linesCapacity = 0;
+        stream->nbrLines = 0;
+        stream->lines = NULL;
+        stream->tokensCapacity = 0;
+        stream->nbrTokens = 0;
+        stream->tokens = NULL;
+        stream->textCapacity = 0;
+        stream->textLength = 0;
+        stream->text = NULL;
+}
+
+int streamAddLine (TokenStream * stream, int lineNum, int PC, int hasLabel,
+                   const char * begin, const char * end)
+  /* Postcondition: A line record and the tokens between begin and end have been added to the stream.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+        TokenSpan    span;         /* The token just found. */
+        TokenLine *  line;
+        size_t       capacity;
+
+        /* Make room for the line record, and for every character of the line
+         *  (the tokens never take more than that).
+         */
+        capacity = stream->linesCapacity;
+        if ( ! reserve ((void **) &stream->lines, &capacity, stream->nbrLines + 1, sizeof(TokenLine)) )
+            return 0;
+        stream->linesCapacity = (int) capacity;
+        if ( ! reserve ((void **) &stream->text, &stream->textCapacity,
+                        stream->textLength + (end - begin), sizeof(char)) )
+            return 0;
+
+        line = &stream->lines[stream->nbrLines++];
+        line->lineNum = lineNum;
+        line->PC = PC;
+        line->firstToken = stream->nbrTokens;
+        line->nbrTokens = 0;
+        line->hasLabel = (short) hasLabel;
+
+        /* Record each token, in one pass over the characters (see getTokenSpan). */
+        while ( getTokenSpan (&begin, end, &span) )
+        {
+            capacity = stream->tokensCapacity;
+            if ( ! reserve ((void **) &stream->tokens, &capacity, stream->nbrTokens + 1, sizeof(TokenRecord)) )
+                return 0;
+            stream->tokensCapacity = (int) capacity;
+
+            stream->tokens[stream->nbrTokens].offset = (unsigned) stream->textLength;
+            stream->tokens[stream->nbrTokens].length = (unsigned) span.length;
+            stream->tokens[stream->nbrTokens].kind = span.kind;
+            stream->nbrTokens++;
+            line->nbrTokens++;
+
+            (void) memcpy (stream->text + stream->textLength, span.begin, span.length);
+            stream->textLength += span.length;
+        }
+        STAT_ADD (STAT_TOKENS, line->nbrTokens);
+
+        return 1;
+}
+
+int streamAppend (TokenStream * stream, const TokenStream * more, int lineNumOffset, int PCOffset)
+  /* Postcondition: Every line of more, with its tokens, has been added to the end of stream, shifted by the offsets.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+        size_t capacity;
+        int    i;
+
+        capacity = stream->linesCapacity;
+        if ( ! reserve ((void **) &stream->lines, &capacity, stream->nbrLines + more->nbrLines, sizeof(TokenLine)) )
+            return 0;
+        stream->linesCapacity = (int) capacity;
+        capacity = stream->tokensCapacity;
+        if ( ! reserve ((void **) &stream->tokens, &capacity, stream->nbrTokens + more->nbrTokens, sizeof(TokenRecord)) )
+            return 0;
+        stream->tokensCapacity = (int) capacity;
+        if ( ! reserve ((void **) &stream->text, &stream->textCapacity,
+                        stream->textLength + more->textLength, sizeof(char)) )
+            return 0;
+
+        /* Lines and tokens point into the arrays that follow, so shift those references too. */
+        for ( i = 0; i < more->nbrLines; i++ )
+        {
+            stream->lines[stream->nbrLines + i] = more->lines[i];
+            stream->lines[stream->nbrLines + i].lineNum += lineNumOffset;
+            stream->lines[stream->nbrLines + i].PC += PCOffset;
+            stream->lines[stream->nbrLines + i].firstToken += stream->nbrTokens;
+        }
+        for ( i = 0; i < more->nbrTokens; i++ )
+        {
+            stream->tokens[stream->nbrTokens + i] = more->tokens[i];
+            stream->tokens[stream->nbrTokens + i].offset += (unsigned) stream->textLength;
+        }
+        if ( more->textLength > 0 )
+            (void) memcpy (stream->text + stream->textLength, more->text, more->textLength);
+
+        stream->nbrLines += more->nbrLines;
+        stream->nbrTokens += more->nbrTokens;
+        stream->textLength += more->textLength;
+        return 1;
+}
+
+TokenSpan streamSpan (const TokenStream * stream, int tokenNbr)
+  /* Returns a span describing token number tokenNbr. */
+{
+        TokenSpan span;
+
+        span.begin = stream->text + stream->tokens[tokenNbr].offset;
+        span.length = stream->tokens[tokenNbr].length;
+        span.kind = stream->tokens[tokenNbr].kind;
+        return span;
+}
+
+void streamClear (TokenStream * stream)
+  /* Postcondition: The stream is empty, but keeps its memory for reuse. */
+{
+        stream->nbrLines = 0;
+        stream->nbrTokens = 0;
+        stream->textLength = 0;
+}
+
+void streamDestroy (TokenStream * stream)
+  /* Postcondition: The stream's memory has been freed and the stream is empty. */
+{
+        free (stream->lines);
+        free (stream->tokens);
+        free (stream->text);
+        streamInit (stream);
+}
+
+static int reserve (void ** array, size_t * capacity, size_t needed, size_t elementSize)
+  /* Postcondition: *array has room for at least needed elements of elementSize bytes,
+   *                  and *capacity is its new capacity; it is at least doubled when it grows.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+        void * newArray;
+        size_t newCapacity;
+
+        if ( needed <= *capacity )
+            return 1;
+
+        newCapacity = 2 * *capacity + 64;
+        if ( newCapacity < needed )
+            newCapacity = needed;
+        if ((newArray = realloc (*array, newCapacity * elementSize)) == NULL)
+        {
+            printError ("%s", ERROR);
+            return 0;           /* FATAL ERROR: Couldn't allocate memory. */
+        }
+
+        *array = newArray;
+        *capacity = newCapacity;
+        return 1;
+}
@@ -0,0 +1,95 @@
+/*
+ * Token Stream: the tokens of a source file, in a compact contiguous form
+ *
+ * This file provides the data structures and declarations for a group
+ * of functions that record the tokens of each instruction line once, so
+ * that a later pass can work from the recorded tokens instead of reading
+ * and scanning the source text again.  pass1 records the stream as it
+ * looks for labels; pass2 then encodes instructions straight from it.
+ *
+ * The stream holds three contiguous arrays:
+ *      lines   -- one record per instruction line (a line with something
+ *                 after its label, if any): its line number, its address,
+ *                 whether it had a label, and which tokens belong to it;
+ *      tokens  -- one record per token (the instruction name, then each
+ *                 operand, split the same way getNTokens splits them):
+ *                 where its characters are in text, how many there are,
+ *                 and what kind of token it is (see TokenSpan in getToken.h);
+ *      text    -- the characters of every token, one after another.
+ * Tokens are read back as token spans, so nothing needs to scan the text
+ * again to find where a token ends or what kind it is.
+ *
+ */
+
+#ifndef _TOKEN_STREAM_H
+#define _TOKEN_STREAM_H
+
+#include <stddef.h>
+
+#include "getToken.h"
+
+/* THE DATA STRUCTURES */
+
+typedef struct {
+        int   lineNum;          /* Line number in the source (the first line is 1). */
+        int   PC;               /* Address of the instruction on the line. */
+        int   firstToken;       /* Number of the line's first token (the instruction name). */
+        short nbrTokens;        /* Number of tokens on the line, including the instruction name. */
+        short hasLabel;         /* 1 if the line began with a label, 0 otherwise. */
+} TokenLine;
+
+typedef struct {
+        unsigned offset;        /* Offset of the token's first character in text. */
+        unsigned length;        /* Number of characters in the token. */
+        int      kind;          /* Kind of token (e.g., TOKEN_REGISTER; see getToken.h). */
+} TokenRecord;
+
+typedef struct {
+        int         linesCapacity;
+        int         nbrLines;
+        TokenLine * lines;
+        int         tokensCapacity;
+        int         nbrTokens;
+        TokenRecord * tokens;
+        size_t      textCapacity;
+        size_t      textLength;
+        char *      text;
+} TokenStream;
+
+
+/* THE FUNCTIONS */
+
+void streamInit (TokenStream * stream);
+        /* Postcondition: The stream is empty. */
+
+int streamAddLine (TokenStream * stream, int lineNum, int PC, int hasLabel,
+                   const char * begin, const char * end);
+        /* Precondition: begin..end is the part of a line after its label (if any) and
+         *                 before its comment (if any), and contains at least one token.
+         * Postcondition: A line record and the tokens between begin and end have been
+         *                  added to the end of the stream.
+         *
+         * Returns 1 if everything went OK;
+         *         0 if memory allocation error
+         */
+
+int streamAppend (TokenStream * stream, const TokenStream * more, int lineNumOffset, int PCOffset);
+        /* Postcondition: Every line of more, with its tokens, has been added to the end of stream,
+         *                  with lineNumOffset added to its line number and PCOffset to its address.
+         *
+         * Returns 1 if everything went OK;
+         *         0 if memory allocation error
+         */
+
+TokenSpan streamSpan (const TokenStream * stream, int tokenNbr);
+        /* Returns a span describing token number tokenNbr.
+         *   The span's characters are only good until the next call to streamAddLine.
+         */
+
+void streamClear (TokenStream * stream);
+        /* Postcondition: The stream is empty, but keeps its memory for reuse. */
+
+void streamDestroy (TokenStream * stream);
+        /* Postcondition: The stream's memory has been freed and the stream is empty. */
+
+#endif
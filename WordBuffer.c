@@ -0,0 +1,176 @@
+/*
+ * Word Buffer: functions to collect and write encoded instruction words
+ *
+ * This file provides the definitions of the functions declared in
+ * WordBuffer.h.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "WordBuffer.h"
+#include "printFuncs.h"
+#include "Stats.h"
+
+/* Internal global variables (global to this file only). */
+static const char * ERROR = "Error: cannot allocate space in memory.\n";
+static const char * WRITE_ERROR = "Error: cannot write the output.\n";
+static const char * HEX_DIGITS = "0123456789abcdef";
+
+/* Characters written for each word, in each output format. */
+static const size_t WORD_SIZES[] = { 33, 9, 4, 4 };
+
+/* The 8 '0' and '1' characters for each byte value, most significant bit first. */
+#define BITS_1(b)   { '0' + ((b) >> 7 & 1), '0' + ((b) >> 6 & 1), '0' + ((b) >> 5 & 1), '0' + ((b) >> 4 & 1), \
+                      '0' + ((b) >> 3 & 1), '0' + ((b) >> 2 & 1), '0' + ((b) >> 1 & 1), '0' + ((b) & 1) }
+#define BITS_4(b)   BITS_1(b), BITS_1((b) + 1), BITS_1((b) + 2), BITS_1((b) + 3)
+#define BITS_16(b)  BITS_4(b), BITS_4((b) + 4), BITS_4((b) + 8), BITS_4((b) + 12)
+#define BITS_64(b)  BITS_16(b), BITS_16((b) + 16), BITS_16((b) + 32), BITS_16((b) + 48)
+static const char BYTE_BITS[256][8] = { BITS_64(0), BITS_64(64), BITS_64(128), BITS_64(192) };
+
+/* Internal function (visible to this file only). */
+static char * renderWord (char * out, uint32_t word, int format);
+
+void wordsInit (WordBuffer * buffer)
+  /* Postcondition: The buffer is empty. */
+{
+        buffer->capacity = 0;
+        buffer->nbrWords = 0;
+        buffer->words = NULL;
+}
+
+int wordsAppend (WordBuffer * buffer, uint32_t word)
+  /* Postcondition: word has been added to the end of the buffer.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+        uint32_t * newWords;
+        int        newCapacity;
+
+        /* Resize the buffer if necessary, doubling its capacity. */
+        if ( buffer->nbrWords >= buffer->capacity )
+        {
+            newCapacity = 2 * buffer->capacity + 64;
+            if ((newWords = realloc (buffer->words, newCapacity * sizeof(uint32_t))) == NULL)
+            {
+                printError ("%s", ERROR);
+                return 0;           /* FATAL ERROR: Couldn't allocate memory. */
+            }
+            buffer->words = newWords;
+            buffer->capacity = newCapacity;
+        }
+
+        buffer->words[buffer->nbrWords++] = word;
+        return 1;
+}
+
+int wordsAppendAll (WordBuffer * buffer, const WordBuffer * more)
+  /* Postcondition: Every word in more has been added, in order, to the end of buffer.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+        uint32_t * newWords;
+
+        if ( buffer->nbrWords + more->nbrWords > buffer->capacity )
+        {
+            if ((newWords = realloc (buffer->words,
+                                     (buffer->nbrWords + more->nbrWords) * sizeof(uint32_t))) == NULL)
+            {
+                printError ("%s", ERROR);
+                return 0;           /* FATAL ERROR: Couldn't allocate memory. */
+            }
+            buffer->words = newWords;
+            buffer->capacity = buffer->nbrWords + more->nbrWords;
+        }
+
+        if ( more->nbrWords > 0 )
+            memcpy (buffer->words + buffer->nbrWords, more->words, more->nbrWords * sizeof(uint32_t));
+        buffer->nbrWords += more->nbrWords;
+        return 1;
+}
+
+void wordsDestroy (WordBuffer * buffer)
+  /* Postcondition: The buffer's memory has been freed and the buffer is empty. */
+{
+        free (buffer->words);
+        wordsInit (buffer);
+}
+
+int wordsWrite (WordBuffer * buffer, int fd, int format)
+  /* Postcondition: Every word in the buffer has been written to fd in the given format.
+   * Returns 1 if everything went OK; 0 if memory allocation or write error.
+   */
+{
+        char *  text;               /* All of the output. */
+        char *  end;                /* End of the output rendered so far. */
+        const char * next;          /* Next character to write. */
+        ssize_t written;
+        int     i;
+
+        if ( buffer->nbrWords == 0 )
+            return 1;
+        if ((text = malloc (buffer->nbrWords * WORD_SIZES[format])) == NULL)
+        {
+            printError ("%s", ERROR);
+            return 0;               /* FATAL ERROR: Couldn't allocate memory. */
+        }
+        STAT_TIMER_START (TIMER_OUTPUT);
+
+        for ( i = 0, end = text; i < buffer->nbrWords; i++ )
+            end = renderWord (end, buffer->words[i], format);
+
+        /* One write normally does it all; keep going if it is interrupted or cut short. */
+        for ( next = text; next < end; next += written )
+            if ((written = write (fd, next, end - next)) < 0)
+            {
+                if ( errno == EINTR )
+                {
+                    written = 0;
+                    continue;
+                }
+                printError ("%s", WRITE_ERROR);
+                free (text);
+                STAT_TIMER_STOP (TIMER_OUTPUT);
+                return 0;           /* FATAL ERROR: Couldn't write. */
+            }
+
+        STAT_ADD (STAT_OUTPUT_BYTES, end - text);
+        free (text);
+        STAT_TIMER_STOP (TIMER_OUTPUT);
+        return 1;
+}
+
+static char * renderWord (char * out, uint32_t word, int format)
+  /* Postcondition: word has been rendered at out in the given format.
+   * Returns a pointer to the character after it.
+   */
+{
+        int i;
+
+        switch ( format )
+        {
+            case OUTPUT_HEX:
+                for ( i = 0; i < 8; i++ )
+                    out[i] = HEX_DIGITS[(word >> (28 - 4 * i)) & 0xf];
+                out[8] = '\n';
+                break;
+            case OUTPUT_LE:
+                for ( i = 0; i < 4; i++ )
+                    out[i] = (char) (word >> (8 * i));
+                break;
+            case OUTPUT_BE:
+                for ( i = 0; i < 4; i++ )
+                    out[i] = (char) (word >> (24 - 8 * i));
+                break;
+            default:
+                for ( i = 0; i < 4; i++ )
+                    memcpy (out + 8 * i, BYTE_BITS[(word >> (24 - 8 * i)) & 0xff], 8);
+                out[32] = '\n';
+                break;
+        }
+
+        return out + WORD_SIZES[format];
+}
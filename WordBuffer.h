@@ -0,0 +1,74 @@
+/*
+ * Word Buffer: a growable array of encoded instruction words
+ *
+ * This file provides the data structure and declarations for a group
+ * of functions that collect the 32-bit words produced by encoding
+ * instructions, so that they can be patched (see Fixups.h) before they
+ * are written out, and for writing words in one of the assembler's
+ * output formats:
+ *      OUTPUT_BITS -- one word per line, as 32 ASCII '0' and '1' characters,
+ *                     most significant bit first (see smallSampleTestfile.mips.out);
+ *      OUTPUT_HEX  -- one word per line, as 8 lowercase hexadecimal digits;
+ *      OUTPUT_LE   -- raw binary, 4 bytes per word, least significant byte first;
+ *      OUTPUT_BE   -- raw binary, 4 bytes per word, most significant byte first.
+ *
+ * wordsWrite renders every word into one buffer and hands it to the
+ * operating system with a single write, rather than printing the words
+ * one at a time.  Bit strings are rendered a byte at a time, by copying
+ * the 8 characters for each byte value from a table.
+ *
+ */
+
+#ifndef _WORD_BUFFER_H
+#define _WORD_BUFFER_H
+
+#include <stdint.h>
+
+/* Output formats. */
+#define OUTPUT_BITS  0
+#define OUTPUT_HEX   1
+#define OUTPUT_LE    2
+#define OUTPUT_BE    3
+
+/* THE DATA STRUCTURE */
+
+typedef struct {
+        int        capacity;    /* Capacity of the buffer. */
+        int        nbrWords;    /* Actual number of words in the buffer. */
+        uint32_t * words;
+} WordBuffer;
+
+
+/* THE FUNCTIONS */
+
+void wordsInit (WordBuffer * buffer);
+        /* Postcondition: The buffer is empty. */
+
+int wordsAppend (WordBuffer * buffer, uint32_t word);
+        /* Postcondition: word has been added to the end of the buffer,
+         *                  which has been resized if necessary.
+         *
+         * Returns 1 if everything went OK;
+         *         0 if memory allocation error
+         */
+
+int wordsAppendAll (WordBuffer * buffer, const WordBuffer * more);
+        /* Postcondition: Every word in more has been added, in order, to the end of buffer.
+         *
+         * Returns 1 if everything went OK;
+         *         0 if memory allocation error
+         */
+
+int wordsWrite (WordBuffer * buffer, int fd, int format);
+        /* Precondition: format is OUTPUT_BITS, OUTPUT_HEX, OUTPUT_LE, or OUTPUT_BE.
+         * Postcondition: Every word in the buffer has been written to the file
+         *                  descriptor fd in the given format.
+         *
+         * Returns 1 if everything went OK;
+         *         0 if memory allocation or write error
+         */
+
+void wordsDestroy (WordBuffer * buffer);
+        /* Postcondition: The buffer's memory has been freed and the buffer is empty. */
+
+#endif
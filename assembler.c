@@ -0,0 +1,119 @@
+/*
+ * This is the main driver for the assembler.  It reads MIPS assembly
+ * source from a file if a filename has been passed as a command-line
+ * argument, or from the standard input otherwise.  pass1 builds a table
+ * of the labels in the source and their addresses; pass2 then processes
+ * each instruction, using the table to resolve labels.  With -s,
+ * onePass does both jobs in a single pass over the input instead.
+ * Either way, the encoded instructions are collected and then written to
+ * the standard output all at once (see wordsWrite in WordBuffer.h).
+ *
+ * USAGE:
+ *      assembler [ -m ] [ -s ] [ -p ] [ -f bits|hex|le|be ] [ -j N ] [ --stats[=text|json] ] [ filename ] [ 0|1 ]
+ * where "filename" is an optional file containing the input to read,
+ *       "0" or "1" specifies that debugging should be turned off or on, respectively,
+ *            regardless of any calls to debug_on, debug_off, or debug_restore in the program, and
+ *       "-m" maps the input file into memory so that both passes read it
+ *            in place rather than through fgets, and
+ *       "-s" assembles in a single pass, patching forward label references
+ *            as their labels are defined, and
+ *       "-p" does the same, but reads, tokenizes, and encodes on separate
+ *            threads at the same time (useful when reading from a pipe), and
+ *       "-f" chooses the output format: 32 '0' and '1' characters per line
+ *            (bits, the default, as in smallSampleTestfile.mips.out),
+ *            8 hexadecimal digits per line (hex), or raw 4-byte words,
+ *            little-endian (le) or big-endian (be), and
+ *       "-j" looks for labels and encodes the instructions on N threads
+ *            (ignored with -s and -p), and
+ *       "--stats" prints counts and times for each part of the work to
+ *            stderr at the end, as text or JSON (see Stats.h).
+ * The filename and debugging choice may appear in either order.
+ *
+ * The exit status is 0 if the input was assembled without errors, and 1
+ * otherwise.  An instruction with errors still takes up its word (see
+ * pass2.c), so the words after it are at the right addresses.
+ *
+ * Without -s, pass1 keeps the tokens of every instruction (see
+ * TokenStream.h) and pass2 encodes the instructions from them, so the
+ * input is only read once either way.
+ *
+ */
+
+#include "assembler.h"
+
+const int SAME = 0;		/* Useful for making strcmp readable. */
+                                /* e.g., if (strcmp (str1, str2) == SAME) */
+
+int main (int argc, char * argv[])
+{
+    FILE * fptr;               /* File pointer. */
+    SourceFile source;         /* Lines of the input, mapped or read through fptr. */
+    LabelTable table;
+    TokenStream stream;        /* Tokens recorded by pass1 for pass2. */
+    WordBuffer words;          /* Encoded instructions. */
+    int    status = 0;         /* Exit status. */
+
+    /* Process command-line arguments (if any)
+	 *      input file name, options, and/or debugging indicator (1 = on; 0 = off).
+     */
+    fptr = process_arguments(argc, argv);
+    if ( fptr == NULL )
+    {
+        return 1;   /* Fatal error when processing arguments */
+    }
+
+    sourceOpen(&source, fptr, OPTIONS.mapInput);
+    wordsInit(&words);
+    streamInit(&stream);
+
+    STAT_TIMER_START(TIMER_PASS1);
+    if ( OPTIONS.pipeline )
+    {
+        /* Read, tokenize, and encode in a pipeline of threads, patching forward references at the end. */
+        table = pipelinePass (fptr, &words);
+        STAT_TIMER_STOP(TIMER_PASS1);
+        if ( debug_is_on() )
+            printLabels (&table);
+    }
+    else if ( OPTIONS.onePass )
+    {
+        /* Read the input once, encoding as we go and patching forward references at the end. */
+        table = onePass (&source, &words);
+        STAT_TIMER_STOP(TIMER_PASS1);
+        if ( debug_is_on() )
+            printLabels (&table);
+    }
+    else
+    {
+        /* Call pass1 to generate the label table and record the instructions' tokens,
+         *  then process the instructions from the recorded tokens.
+         */
+        table = pass1Parallel (&source, &stream, OPTIONS.nbrThreads);
+        STAT_TIMER_STOP(TIMER_PASS1);
+        if ( debug_is_on() )
+            printLabels (&table);       /* Print the label table if debugging is turned on. */
+        /* Debugging messages would be interleaved by several threads, so use just one. */
+        STAT_TIMER_START(TIMER_PASS2);
+        pass2Parallel (&stream, table, &words, debug_is_on() ? 1 : OPTIONS.nbrThreads);
+        STAT_TIMER_STOP(TIMER_PASS2);
+    }
+
+    /* Write all of the words at once, after anything already printed to stdout. */
+    (void) fflush(stdout);
+    if ( ! wordsWrite (&words, fileno(stdout), OPTIONS.outputFormat) )
+        status = 1;
+
+    /* Every instruction has a word, even one with errors, but the output is not a valid program. */
+    if ( errorCount () > 0 )
+        status = 1;
+
+    if ( OPTIONS.stats )
+        statsReport (stderr, OPTIONS.stats);
+
+    streamDestroy(&stream);
+    wordsDestroy(&words);
+    tableDestroy(&table);
+    sourceClose(&source);
+    (void) fclose(fptr);
+    return status;
+}
@@ -14,15 +14,40 @@
 #include <stdlib.h>     /* May need to be _stdlib.h on some machines. */
 #include <string.h>	/* Might be memory.h on some machines. */
 #include <ctype.h>
+#include <stdint.h>
 
 #include "LabelTable.h"
+#include "SharedLabelTable.h"
+#include "SourceFile.h"
+#include "TokenStream.h"
+#include "WordBuffer.h"
+#include "Fixups.h"
+#include "CharScan.h"
+#include "InstructionSet.h"
 #include "getToken.h"
 #include "printFuncs.h"
+#include "Stats.h"
 #include "process_arguments.h"
 #include "same.h"
 
 int getNTokens (char * instructionBuffer, int N, char * results[]);
+int getNTokensN (const char * begin, const char * end, int N, TokenSpan results[]);
 LabelTable pass1 (FILE * fp);
-void pass2 (FILE * fp, LabelTable table);
+LabelTable pass1Source (SourceFile * source);
+LabelTable pass1Tokenize (SourceFile * source, TokenStream * stream);
+LabelTable pass1Parallel (SourceFile * source, TokenStream * stream, int nbrThreads);
+int pass1Line (const LineView * line, int lineNum, int PC, LineView * label,
+               TokenStream * stream);
+int pass1EstimateLabels (const SourceFile * source);
+void pass2Tokens (const TokenStream * stream, LabelTable table, WordBuffer * words);
+void pass2Parallel (const TokenStream * stream, LabelTable table, WordBuffer * words, int nbrThreads);
+int encodeTokens (const TokenStream * stream, const TokenLine * line,
+                  uint32_t * word, LabelRef * ref);
+LabelTable onePass (SourceFile * source, WordBuffer * words);
+int onePassLabel (LabelTable * table, FixupList * fixups, const char * labelBegin, size_t length,
+                  int PC, WordBuffer * words);
+int onePassLine (const TokenStream * stream, const TokenLine * line, LabelTable * table,
+                 FixupList * fixups, WordBuffer * words);
+LabelTable pipelinePass (FILE * fp, WordBuffer * words);
 
 #endif
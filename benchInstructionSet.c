@@ -0,0 +1,188 @@
+/*
+ * Benchmark of instruction mnemonic and register name lookup:
+ *      chain   -- strcmp against each name in InstructionList.h in turn,
+ *                 as a chain of if-else strcmp calls would;
+ *      perfect -- lookupMnemonic and lookupRegister (see InstructionSet.h).
+ *
+ * The names looked up are the mnemonics and registers of
+ * smallSampleTestfile.mips, in the order they appear there, plus some
+ * names that are neither, so that misses are timed too.  Before timing,
+ * the benchmark checks that both ways give the same answer for every
+ * listed name and for the extra names, and reports any that differ.
+ * Results are printed one per line, as space-separated key=value pairs,
+ * e.g.:
+ *
+ *      table=mnemonic method=perfect lookups=10000000 ns_per_lookup=2.1
+ *
+ * USAGE:
+ *      benchInstructionSet [ lookups ]
+ * where lookups is the number of lookups timed for each table and method
+ * (default: 10000000).
+ */
+
+#include <time.h>
+
+#include "assembler.h"
+
+const int SAME = 0;		/* Useful for making strcmp readable. */
+                                /* e.g., if (strcmp (str1, str2) == SAME) */
+
+/* The list, for the strcmp chain. */
+typedef struct {
+    const char * name;
+    int          value;         /* Opcode and funct (opcode * 64 + funct), or register number. */
+} ChainEntry;
+
+#define INSTRUCTION(name, format, opcode, funct) { name, (opcode) * 64 + (funct) },
+#define REGISTER(name, number)
+static const ChainEntry MNEMONICS[] = {
+#include "InstructionList.h"
+};
+#undef INSTRUCTION
+#undef REGISTER
+
+#define INSTRUCTION(name, format, opcode, funct)
+#define REGISTER(name, number) { name, number },
+static const ChainEntry REGISTERS[] = {
+#include "InstructionList.h"
+};
+#undef INSTRUCTION
+#undef REGISTER
+
+#define NBR_MNEMONICS ((int) (sizeof MNEMONICS / sizeof *MNEMONICS))
+#define NBR_REGISTERS ((int) (sizeof REGISTERS / sizeof *REGISTERS))
+
+/* Names looked up in the timing loops (from smallSampleTestfile.mips, plus misses). */
+static const char * SAMPLE_MNEMONICS[] = {
+    "lw", "addi", "addi", "slt", "bne", "add", "addi", "j", "add", "nop", "move"
+};
+static const char * SAMPLE_REGISTERS[] = {
+    "$a0", "$t0", "$t0", "$zero", "$t1", "$zero", "$t2", "$a0", "$t1", "$t2", "$zero",
+    "$t0", "$t0", "$t1", "$t1", "$t1", "$v0", "$t0", "$zero", "$32", "$x"
+};
+#define NBR_SAMPLE_MNEMONICS ((int) (sizeof SAMPLE_MNEMONICS / sizeof *SAMPLE_MNEMONICS))
+#define NBR_SAMPLE_REGISTERS ((int) (sizeof SAMPLE_REGISTERS / sizeof *SAMPLE_REGISTERS))
+
+static double now(void);
+static int chainLookup(const ChainEntry * list, int n, const char * name);
+static int perfectMnemonic(const char * name);
+static int perfectRegister(const char * name);
+static int checkTable(const char * table, const ChainEntry * list, int n,
+                      const char ** samples, int nbrSamples, int (*perfect)(const char *));
+static void timeTable(const char * table, const ChainEntry * list, int n, const char ** samples,
+                      int nbrSamples, long nbrLookups);
+
+int main(int argc, char * argv[])
+{
+    long nbrLookups = argc > 1 ? atol(argv[1]) : 10000000;
+    int  mismatches;
+
+    mismatches = checkTable("mnemonic", MNEMONICS, NBR_MNEMONICS,
+                            SAMPLE_MNEMONICS, NBR_SAMPLE_MNEMONICS, perfectMnemonic)
+               + checkTable("register", REGISTERS, NBR_REGISTERS,
+                            SAMPLE_REGISTERS, NBR_SAMPLE_REGISTERS, perfectRegister);
+    printf("check=lookup mismatches=%d\n", mismatches);
+
+    timeTable("mnemonic", MNEMONICS, NBR_MNEMONICS,
+              SAMPLE_MNEMONICS, NBR_SAMPLE_MNEMONICS, nbrLookups);
+    timeTable("register", REGISTERS, NBR_REGISTERS,
+              SAMPLE_REGISTERS, NBR_SAMPLE_REGISTERS, nbrLookups);
+
+    return mismatches != 0;
+}
+
+/*
+ * chainLookup returns the value of name in list, comparing it with each
+ * listed name in turn, or -1 if it is not there.
+ */
+static int chainLookup(const ChainEntry * list, int n, const char * name)
+{
+    int i;
+
+    for ( i = 0; i < n; i++ )
+        if ( strcmp(list[i].name, name) == SAME )
+            return list[i].value;
+    return -1;
+}
+
+static int perfectMnemonic(const char * name)
+{
+    const Mnemonic * mnemonic = lookupMnemonic(name, strlen(name));
+
+    return mnemonic == NULL ? -1 : (int) (mnemonic->opcode * 64 + mnemonic->funct);
+}
+
+static int perfectRegister(const char * name)
+{
+    return lookupRegister(name, strlen(name));
+}
+
+/*
+ * checkTable prints and counts the names for which the chain and the
+ * perfect hash disagree.
+ */
+static int checkTable(const char * table, const ChainEntry * list, int n,
+                      const char ** samples, int nbrSamples, int (*perfect)(const char *))
+{
+    int i, mismatches = 0;
+
+    for ( i = 0; i < n + nbrSamples; i++ )
+    {
+        const char * name = i < n ? list[i].name : samples[i - n];
+
+        if ( chainLookup(list, n, name) != perfect(name) )
+        {
+            printf("check=%s name=%s chain=%d perfect=%d\n",
+                   table, name, chainLookup(list, n, name), perfect(name));
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+/*
+ * timeTable times nbrLookups lookups of the sample names, cycling
+ * through them, with each method.  The lengths are not part of the
+ * timing: the assembler's tokens already know them.
+ */
+static void timeTable(const char * table, const ChainEntry * list, int n, const char ** samples,
+                      int nbrSamples, long nbrLookups)
+{
+    size_t   lengths[32];
+    long     i;
+    int      s;
+    volatile int sink = 0;      /* Keeps the lookups from being optimized away. */
+    double   start, seconds;
+
+    for ( s = 0; s < nbrSamples; s++ )
+        lengths[s] = strlen(samples[s]);
+
+    start = now();
+    for ( i = 0, s = 0; i < nbrLookups; i++, s = s + 1 == nbrSamples ? 0 : s + 1 )
+        sink += chainLookup(list, n, samples[s]);
+    seconds = now() - start;
+    printf("table=%s method=chain lookups=%ld ns_per_lookup=%.2f\n",
+           table, nbrLookups, seconds * 1e9 / nbrLookups);
+
+    start = now();
+    if ( list == MNEMONICS )
+        for ( i = 0, s = 0; i < nbrLookups; i++, s = s + 1 == nbrSamples ? 0 : s + 1 )
+        {
+            const Mnemonic * mnemonic = lookupMnemonic(samples[s], lengths[s]);
+            sink += mnemonic == NULL ? -1 : (int) mnemonic->opcode;
+        }
+    else
+        for ( i = 0, s = 0; i < nbrLookups; i++, s = s + 1 == nbrSamples ? 0 : s + 1 )
+            sink += lookupRegister(samples[s], lengths[s]);
+    seconds = now() - start;
+    printf("table=%s method=perfect lookups=%ld ns_per_lookup=%.2f\n",
+           table, nbrLookups, seconds * 1e9 / nbrLookups);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,225 @@
+/*
+ * Benchmark of label lookup latency for the three ways a label table
+ * can be searched:
+ *      linear  -- a table without a hash index, which findLabel scans
+ *                 from the first entry (the original label table),
+ *      hashed  -- the open-addressing hash index that addLabel maintains,
+ *      frozen  -- the single-probe perfect-hash layout built by tableFreeze.
+ *
+ * For each table size, the benchmark adds that many generated labels,
+ * then times findLabel on labels chosen at random from the table, and,
+ * for the hashed layout, on as many labels that are not in the table
+ * (as addLabel's search for a duplicate is).  Linear lookups are
+ * expensive for large tables, so fewer of them are timed.  Results are printed one per line, as space-separated
+ * key=value pairs, e.g.:
+ *
+ *      labels=1000 layout=hashed lookups=1000000 ns_per_lookup=21.4
+ *
+ * For each table size, the benchmark also builds the table again with
+ * each of several growth factors (see TABLE_GROWTH_FACTOR in LabelTable.h),
+ * and once more in a table resized to hold every label to begin with (as
+ * pass1 does with its estimate), and prints how many times the table was
+ * resized, how many bytes of entries those resizes carried over, how many
+ * of those bytes realloc had to move, and how long the build took, e.g.:
+ *
+ *      labels=1000 growth=2.00 resizes=10 bytes_copied=24312 bytes_moved=0 capacity=1023 seconds=0.000043
+ *
+ * USAGE:
+ *      benchLabelTable [ size ... ]
+ * where each optional size is a number of labels (default: 1000 100000 1000000).
+ */
+
+#include <time.h>
+
+#include "assembler.h"
+
+const int SAME = 0;		/* Useful for making strcmp readable. */
+                                /* e.g., if (strcmp (str1, str2) == SAME) */
+
+/* Number of lookups timed for the hashed and frozen layouts. */
+static const int NBR_LOOKUPS = 1000000;
+
+/* Budget of label comparisons for the linear layout (lookups * size / 2). */
+static const double LINEAR_BUDGET = 2e8;
+
+/* Growth factors whose resize traffic is measured. */
+static const double GROWTH_FACTORS[] = { 1.25, 1.5, 2.0, 4.0 };
+
+static double now(void);
+static double timeLookups(LabelTable * table, char ** names, int * order, int nbrLookups);
+static void benchSize(int size);
+static void benchGrowth(int size, char ** names, double factor);
+
+int main(int argc, char * argv[])
+{
+    int i;
+
+    if ( argc > 1 )
+        for ( i = 1; i < argc; i++ )
+            benchSize(atoi(argv[i]));
+    else
+    {
+        benchSize(1000);
+        benchSize(100000);
+        benchSize(1000000);
+    }
+
+    return 0;
+}
+
+/*
+ * benchSize builds a table of the given number of generated labels and
+ * prints the lookup latency of each layout.
+ */
+static void benchSize(int size)
+{
+    LabelTable table;
+    char *     storage = malloc((size_t) size * 16 * 2);
+    char **    names = malloc((size_t) size * 2 * sizeof(char *));   /* The labels, then labels not added. */
+    int *      order = malloc((size_t) NBR_LOOKUPS * sizeof(int));
+    IndexGroup * index;
+    unsigned   random = 12345;
+    int        i;
+    int        nbrLinear;
+    double     start, seconds;
+
+    if ( size < 1 || storage == NULL || names == NULL || order == NULL )
+    {
+        printError("Error: cannot allocate space in memory.\n");
+        free(storage); free(names); free(order);
+        return;
+    }
+
+    /* Generate the labels, others like them, and a random order in which to look them up. */
+    for ( i = 0; i < 2 * size; i++ )
+    {
+        names[i] = storage + (size_t) i * 16;
+        sprintf(names[i], i < size ? "label_%07d" : "other_%07d", i % size);
+    }
+    for ( i = 0; i < NBR_LOOKUPS; i++ )
+    {
+        random = random * 1103515245u + 12345u;
+        order[i] = (int) ((random >> 8) % (unsigned) size);
+    }
+
+    /* Measure the resizes made while building the table with each growth factor, and without any. */
+    for ( i = 0; i < (int) (sizeof(GROWTH_FACTORS) / sizeof(GROWTH_FACTORS[0])); i++ )
+        benchGrowth(size, names, GROWTH_FACTORS[i]);
+    benchGrowth(size, names, 0);
+    TABLE_GROWTH_FACTOR = 2.0;
+
+    /* Build the table. */
+    tableInit(&table);
+    start = now();
+    for ( i = 0; i < size; i++ )
+        addLabel(&table, names[i], 4 * i);
+    seconds = now() - start;
+    printf("labels=%d phase=build seconds=%.6f\n", size, seconds);
+
+    /* Linear: hide the hash index so that the table is scanned. */
+    nbrLinear = (int) (LINEAR_BUDGET / (size / 2.0 + 1));
+    nbrLinear = nbrLinear > NBR_LOOKUPS ? NBR_LOOKUPS : nbrLinear < 100 ? 100 : nbrLinear;
+    index = table.index;
+    table.index = NULL;
+    printf("labels=%d layout=linear lookups=%d ns_per_lookup=%.1f\n",
+           size, nbrLinear, timeLookups(&table, names, order, nbrLinear));
+    table.index = index;
+
+    printf("labels=%d layout=hashed lookups=%d ns_per_lookup=%.1f\n",
+           size, NBR_LOOKUPS, timeLookups(&table, names, order, NBR_LOOKUPS));
+    printf("labels=%d layout=hashed_missing lookups=%d ns_per_lookup=%.1f\n",
+           size, NBR_LOOKUPS, timeLookups(&table, names + size, order, NBR_LOOKUPS));
+
+    start = now();
+    if ( tableFreeze(&table) )
+    {
+        seconds = now() - start;
+        printf("labels=%d phase=freeze seconds=%.6f\n", size, seconds);
+        printf("labels=%d layout=frozen lookups=%d ns_per_lookup=%.1f\n",
+               size, NBR_LOOKUPS, timeLookups(&table, names, order, NBR_LOOKUPS));
+    }
+    else
+        printf("labels=%d layout=frozen error=not_frozen\n", size);
+
+    tableDestroy(&table);
+    free(storage); free(names); free(order);
+}
+
+/*
+ * benchGrowth adds the first size names to a new table that grows by the
+ * given factor, or, if factor is 0, to one resized to hold them all to
+ * begin with, and prints the number of resizes, the bytes of entries they
+ * carried over to the new capacity, the bytes of those that realloc had to
+ * move (when it could not extend the entries where they were), and the time
+ * taken.  The resizes are the ones that actually happened: the table is
+ * watched after every addLabel for a change of capacity.
+ */
+static void benchGrowth(int size, char ** names, double factor)
+{
+    LabelTable   table;
+    int          nbrResizes = 0;
+    double       bytesCopied = 0;
+    double       bytesMoved = 0;
+    int          capacity;
+    LabelEntry * entries;
+    int          i;
+    double       start, seconds;
+
+    tableInit(&table);
+    TABLE_GROWTH_FACTOR = factor;
+    start = now();
+    if ( factor == 0 )
+    {
+        (void) tableResize(&table, size);
+        nbrResizes++;
+    }
+    for ( i = 0; i < size; i++ )
+    {
+        /* A resize carries over the entries already in the table (all but the one being added). */
+        capacity = table.capacity;
+        entries = table.entries;
+        addLabel(&table, names[i], 4 * i);
+        if ( table.capacity != capacity )
+        {
+            nbrResizes++;
+            bytesCopied += (double) (table.nbrLabels - 1) * sizeof(LabelEntry);
+            if ( table.entries != entries )
+                bytesMoved += (double) (table.nbrLabels - 1) * sizeof(LabelEntry);
+        }
+    }
+    seconds = now() - start;
+
+    if ( factor == 0 )
+        printf("labels=%d growth=presized", size);
+    else
+        printf("labels=%d growth=%.2f", size, factor);
+    printf(" resizes=%d bytes_copied=%.0f bytes_moved=%.0f capacity=%d seconds=%.6f\n",
+           nbrResizes, bytesCopied, bytesMoved, table.capacity, seconds);
+
+    tableDestroy(&table);
+}
+
+/*
+ * timeLookups looks up names[order[i]] for the first nbrLookups entries
+ * of order and returns the average time per lookup in nanoseconds.
+ */
+static double timeLookups(LabelTable * table, char ** names, int * order, int nbrLookups)
+{
+    volatile long checksum = 0;
+    double        start = now();
+    int           i;
+
+    for ( i = 0; i < nbrLookups; i++ )
+        checksum += findLabel(table, names[order[i]]);
+
+    return (now() - start) * 1e9 / nbrLookups;
+}
+
+/* Returns the current time, in seconds, from a monotonic clock. */
+static double now(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,164 @@
+/*
+ * Benchmark of pass2 scaling with the number of threads.
+ *
+ * The benchmark writes a synthetic assembly source to a temporary file: a
+ * label every LABEL_EVERY lines, and instructions of every format, the
+ * branches and jumps going to the labels around them.  It runs pass1 on
+ * it once, then times pass2Parallel (see pass2.c) on the recorded tokens
+ * with 1, 2, 4, ... threads up to the requested number, checking that
+ * every run produces the same words as the run on one thread.  Each
+ * number of threads is timed several times and the best time is reported.
+ * Results are printed one per line, as space-separated key=value pairs,
+ * e.g.:
+ *
+ *      threads=4 lines=2000000 words=2000000 seconds=0.120 lines_per_s=16666666 speedup=3.40 identical=1
+ *
+ * The speedup can be no better than the number of processors the machine
+ * actually has (printed first, as cpus=N).
+ *
+ * USAGE:
+ *      benchPass2 [ lines [ threads ] ]
+ * where lines is the number of lines to assemble (default: 2000000), and
+ *       threads is the largest number of threads to time (default: 8).
+ */
+
+#include <time.h>
+#include <unistd.h>
+
+#include "assembler.h"
+
+const int SAME = 0;		/* Useful for making strcmp readable. */
+                                /* e.g., if (strcmp (str1, str2) == SAME) */
+
+/* Number of times each number of threads is timed. */
+static const int NBR_RUNS = 3;
+
+/* Number of lines between labels. */
+static const int LABEL_EVERY = 16;
+
+static double now(void);
+static FILE * buildSource(long nbrLines);
+
+int main(int argc, char * argv[])
+{
+    long       nbrLines = argc > 1 ? atol(argv[1]) : 2000000;
+    int        maxThreads = argc > 2 ? atoi(argv[2]) : 8;
+    FILE *     fp;
+    SourceFile source;
+    LabelTable table;
+    TokenStream stream;
+    WordBuffer serial;             /* Words from the run on one thread. */
+    WordBuffer words;
+    int        nbrThreads;
+    int        run, identical;
+    double     start, seconds, best, serialBest = 0;
+
+    ERROR_LIMIT = 0;                /* Errors are not expected; don't let them stop the timing. */
+    if ( (fp = buildSource(nbrLines)) == NULL )
+        return 1;
+    sourceOpen(&source, fp, 1);
+    streamInit(&stream);
+    table = pass1Tokenize(&source, &stream);
+    wordsInit(&serial);
+
+    printf("cpus=%ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+    for ( nbrThreads = 1; nbrThreads <= maxThreads; nbrThreads *= 2 )
+    {
+        best = 0;
+        identical = 1;
+        for ( run = 0; run < NBR_RUNS; run++ )
+        {
+            wordsInit(&words);
+            start = now();
+            pass2Parallel(&stream, table, &words, nbrThreads);
+            seconds = now() - start;
+            if ( run == 0 || seconds < best )
+                best = seconds;
+
+            /* Keep the first run's words to compare the others with. */
+            if ( nbrThreads == 1 && run == 0 )
+            {
+                serial = words;
+                continue;
+            }
+            if ( words.nbrWords != serial.nbrWords ||
+                 memcmp(words.words, serial.words, words.nbrWords * sizeof(uint32_t)) != 0 )
+                identical = 0;
+            wordsDestroy(&words);
+        }
+        if ( nbrThreads == 1 )
+            serialBest = best;
+
+        printf("threads=%d lines=%ld words=%d seconds=%.6f lines_per_s=%.0f speedup=%.2f identical=%d\n",
+               nbrThreads, nbrLines, serial.nbrWords, best, nbrLines / best,
+               serialBest / best, identical);
+    }
+
+    wordsDestroy(&serial);
+    streamDestroy(&stream);
+    tableDestroy(&table);
+    sourceClose(&source);
+    (void) fclose(fp);
+    return 0;
+}
+
+/*
+ * buildSource writes nbrLines lines of assembly to a temporary file and
+ * returns it, positioned at the start.  It returns NULL (after printing
+ * an error) if the file cannot be written.
+ */
+static FILE * buildSource(long nbrLines)
+{
+    static const char * BODY[] = {
+        "add $t0, $t1, $t2",
+        "lw $a0, 4($sp)",
+        "addi $t0, $t0, -1    # count down",
+        "slt $t2, $a0, $t1",
+        "bne $t2, $zero, L%ld",
+        "sll $t3, $t3, 2",
+        "j L%ld",
+        "sw $ra, 0($sp)",
+    };
+    const int  nbrBody = sizeof(BODY) / sizeof(BODY[0]);
+    FILE *     fp;
+    long       i, label;
+
+    if ( (fp = tmpfile()) == NULL )
+    {
+        printError("Error: cannot create a temporary file.\n");
+        return NULL;
+    }
+
+    for ( i = 0; i < nbrLines; i++ )
+    {
+        /* Branches go back to this block's label, jumps forward to the next one's. */
+        label = i / LABEL_EVERY;
+        if ( i % LABEL_EVERY == 0 )
+            fprintf(fp, "L%ld: ", label);
+        else
+            fputs("    ", fp);
+        if ( (i % nbrBody) == 6 && (i + LABEL_EVERY) / LABEL_EVERY * LABEL_EVERY < nbrLines )
+            label++;
+        else if ( (i % nbrBody) == 6 )
+            label = 0;
+        fprintf(fp, BODY[i % nbrBody], label);
+        fputc('\n', fp);
+    }
+
+    if ( fflush(fp) != 0 || ferror(fp) )
+    {
+        printError("Error: cannot write the temporary file.\n");
+        (void) fclose(fp);
+        return NULL;
+    }
+    rewind(fp);
+    return fp;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
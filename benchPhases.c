@@ -0,0 +1,376 @@
+/*
+ * Benchmark of the assembler's phases, one at a time, on a given source.
+ *
+ * The benchmark maps the source (see SourceFile.h) and times each of
+ * these separately:
+ *      pass1      -- pass1Tokenize, which builds the label table and
+ *                    records the tokens of every instruction line;
+ *      addLabel   -- tableInit and addLabel for every label pass1 found,
+ *                    into a new table;
+ *      findLabel  -- findLabel on those labels, in a random order, both in
+ *                    the table addLabel built (the hash index) and in the
+ *                    table from pass1 (which pass1 freezes);
+ *      getToken   -- getToken on every line, on null-terminated copies of
+ *                    the lines with their comments cut off;
+ *      getNTokens -- getNTokens on the same copies (refreshed before each
+ *                    run, since getNTokens writes into them), and
+ *                    getNTokensN on the lines in place;
+ *      pass2      -- pass2Tokens, which encodes the recorded tokens.
+ * Each phase is timed several times and the best time is reported, along
+ * with the time per unit of work (a line, label, lookup, or instruction).
+ * Nothing about a run depends on the clock or on earlier runs, so the
+ * same source always gives the same counts.  Results are printed one per
+ * line, as space-separated key=value pairs, e.g.:
+ *
+ *      phase=pass1 unit=line count=1000000 seconds=0.151210 ns_per_unit=151.2
+ *
+ * The first line describes the source.  Sources of any size and shape
+ * can be written by genSource; "make bench" writes one and runs this on it.
+ *
+ * USAGE:
+ *      benchPhases filename [ runs ]
+ * where filename is the source to assemble, and
+ *       runs is the number of times each phase is timed (default: 5).
+ */
+
+#include <time.h>
+
+#include "assembler.h"
+
+const int SAME = 0;		/* Useful for making strcmp readable. */
+                                /* e.g., if (strcmp (str1, str2) == SAME) */
+
+/* Number of label lookups timed in each table. */
+static const int NBR_LOOKUPS = 1000000;
+
+/* Most tokens a line may have for the getNTokens phases. */
+#define MAX_TOKENS 8
+
+/* A line of the source, as the tokenizing phases see it. */
+typedef struct {
+        const char * begin;     /* First character of the line in the mapping. */
+        const char * end;       /* End of the line, or the start of its comment. */
+        size_t copy;            /* Offset of the line's null-terminated copy. */
+        int    nbrTokens;       /* Number of tokens on the line, including its label. */
+} BenchLine;
+
+static int nbrRuns = 5;
+
+static double now(void);
+static void report(const char * phase, const char * unit, long count, double seconds);
+static long tokenizeCopies(const char * copies, const BenchLine * lines, long nbrLines);
+static long getNTokensCopies(char * copies, const BenchLine * lines, long nbrLines);
+static long getNTokensInPlace(const BenchLine * lines, long nbrLines);
+static long lookupAll(LabelTable * table, char ** names, const int * order);
+
+int main(int argc, char * argv[])
+{
+    FILE *      fp;
+    SourceFile  source;
+    LineView    view;
+    BenchLine * lines = NULL;
+    long        nbrLines = 0;
+    char *      copies;               /* Null-terminated copies of the lines. */
+    char *      work;                 /* Copies for getNTokens to write into. */
+    size_t      copiesSize = 0;
+    size_t      offset;
+    const char * tokBegin, * tokEnd;
+    LabelTable  table, built;
+    TokenStream stream;
+    WordBuffer  words;
+    char **     names;
+    int *       order;
+    unsigned    random = 12345;
+    long        count = 0;
+    int         i, run;
+    double      start, seconds, best;
+
+    if ( argc < 2 )
+    {
+        printError("Usage: %s filename [ runs ]\n", argv[0]);
+        return 1;
+    }
+    if ( argc > 2 && (nbrRuns = atoi(argv[2])) < 1 )
+        nbrRuns = 1;
+    if ( (fp = fopen(argv[1], "r")) == NULL )
+    {
+        printError("Error: Cannot open file %s.\n", argv[1]);
+        return 1;
+    }
+    sourceOpen(&source, fp, 1);
+    if ( ! sourceIsMapped(&source) )
+    {
+        printError("Error: cannot map %s.\n", argv[1]);
+        return 1;
+    }
+    ERROR_LIMIT = 0;                /* Errors are not expected; don't let them stop the timing. */
+
+    /* Find the lines, and where each one's copy will go. */
+    (void) scanComment(source.data, source.data);     /* Choose the scanners before timing. */
+    for ( offset = 0; offset < source.size; offset++ )
+        count += source.data[offset] == '\n';
+    if ( (lines = malloc((count + 1) * sizeof(BenchLine))) == NULL )
+    {
+        printError("Error: cannot allocate space in memory.\n");
+        return 1;
+    }
+    while ( sourceNextLine(&source, &view) )
+    {
+        lines[nbrLines].begin = view.begin;
+        lines[nbrLines].end = scanComment(view.begin, view.begin + view.length);
+        lines[nbrLines].copy = copiesSize;
+        lines[nbrLines].nbrTokens = 0;
+        for ( tokBegin = view.begin; tokBegin < lines[nbrLines].end; tokBegin = tokEnd + 1 )
+        {
+            getTokenN(&tokBegin, &tokEnd, lines[nbrLines].end);
+            if ( tokBegin == lines[nbrLines].end )
+                break;
+            lines[nbrLines].nbrTokens++;
+            if ( tokEnd == lines[nbrLines].end )
+                break;
+        }
+        copiesSize += lines[nbrLines].end - view.begin + 1;
+        nbrLines++;
+    }
+    if ( (copies = malloc(copiesSize + 1)) == NULL || (work = malloc(copiesSize + 1)) == NULL )
+    {
+        printError("Error: cannot allocate space in memory.\n");
+        return 1;
+    }
+    for ( i = 0; i < nbrLines; i++ )
+    {
+        memcpy(copies + lines[i].copy, lines[i].begin, lines[i].end - lines[i].begin);
+        copies[lines[i].copy + (lines[i].end - lines[i].begin)] = '\0';
+    }
+
+    /* pass1: keep the last run's table and stream for the phases after it. */
+    streamInit(&stream);
+    tableInit(&table);
+    best = 0;
+    for ( run = 0; run < nbrRuns; run++ )
+    {
+        tableDestroy(&table);
+        streamClear(&stream);
+        sourceRewind(&source);
+        start = now();
+        table = pass1Tokenize(&source, &stream);
+        seconds = now() - start;
+        if ( run == 0 || seconds < best )
+            best = seconds;
+    }
+    printf("source=%s lines=%ld bytes=%lu labels=%d instructions=%d tokens=%d\n",
+           argv[1], nbrLines, (unsigned long) source.size, table.nbrLabels,
+           stream.nbrLines, stream.nbrTokens);
+    report("pass1", "line", nbrLines, best);
+
+    /* The labels pass1 found, and a random order in which to look them up. */
+    names = malloc((table.nbrLabels + 1) * sizeof(char *));
+    order = malloc(NBR_LOOKUPS * sizeof(int));
+    if ( names == NULL || order == NULL )
+    {
+        printError("Error: cannot allocate space in memory.\n");
+        return 1;
+    }
+    for ( i = 0; i < table.nbrLabels; i++ )
+        names[i] = table.entries[i].label;
+    for ( i = 0; i < NBR_LOOKUPS && table.nbrLabels > 0; i++ )
+    {
+        random = random * 1103515245u + 12345u;
+        order[i] = (int) ((random >> 8) % (unsigned) table.nbrLabels);
+    }
+
+    /* addLabel: keep the last run's table for findLabel. */
+    tableInit(&built);
+    best = 0;
+    for ( run = 0; run < nbrRuns; run++ )
+    {
+        tableDestroy(&built);
+        start = now();
+        tableInit(&built);
+        for ( i = 0; i < table.nbrLabels; i++ )
+            addLabel(&built, names[i], 4 * i);
+        seconds = now() - start;
+        if ( run == 0 || seconds < best )
+            best = seconds;
+    }
+    report("addLabel", "label", table.nbrLabels, best);
+
+    /* findLabel, in the hash index and in the frozen table. */
+    if ( table.nbrLabels > 0 )
+    {
+        best = 0;
+        for ( run = 0; run < nbrRuns; run++ )
+        {
+            start = now();
+            count = lookupAll(&built, names, order);
+            seconds = now() - start;
+            if ( run == 0 || seconds < best )
+                best = seconds;
+        }
+        report("findLabel layout=hashed", "lookup", count, best);
+
+        best = 0;
+        for ( run = 0; run < nbrRuns; run++ )
+        {
+            start = now();
+            count = lookupAll(&table, names, order);
+            seconds = now() - start;
+            if ( run == 0 || seconds < best )
+                best = seconds;
+        }
+        report(table.nbrFrozenSlots > 0 ? "findLabel layout=frozen" : "findLabel layout=pass1",
+               "lookup", count, best);
+    }
+    tableDestroy(&built);
+
+    /* getToken on the copies. */
+    best = 0;
+    for ( run = 0; run < nbrRuns; run++ )
+    {
+        start = now();
+        count = tokenizeCopies(copies, lines, nbrLines);
+        seconds = now() - start;
+        if ( run == 0 || seconds < best )
+            best = seconds;
+    }
+    report("getToken", "token", count, best);
+
+    /* getNTokens on fresh copies, then getNTokensN in place. */
+    best = 0;
+    for ( run = 0; run < nbrRuns; run++ )
+    {
+        memcpy(work, copies, copiesSize);
+        start = now();
+        count = getNTokensCopies(work, lines, nbrLines);
+        seconds = now() - start;
+        if ( run == 0 || seconds < best )
+            best = seconds;
+    }
+    report("getNTokens", "token", count, best);
+
+    best = 0;
+    for ( run = 0; run < nbrRuns; run++ )
+    {
+        start = now();
+        count = getNTokensInPlace(lines, nbrLines);
+        seconds = now() - start;
+        if ( run == 0 || seconds < best )
+            best = seconds;
+    }
+    report("getNTokensN", "token", count, best);
+
+    /* pass2 on the tokens pass1 recorded. */
+    best = 0;
+    for ( run = 0; run < nbrRuns; run++ )
+    {
+        wordsInit(&words);
+        start = now();
+        pass2Tokens(&stream, table, &words);
+        seconds = now() - start;
+        if ( run == 0 || seconds < best )
+            best = seconds;
+        count = words.nbrWords;
+        wordsDestroy(&words);
+    }
+    report("pass2", "instruction", count, best);
+
+    free(names); free(order);
+    free(copies); free(work); free(lines);
+    streamDestroy(&stream);
+    tableDestroy(&table);
+    sourceClose(&source);
+    (void) fclose(fp);
+    return 0;
+}
+
+/*
+ * tokenizeCopies calls getToken on every null-terminated copy until its
+ * null byte, and returns the number of tokens found.
+ */
+static long tokenizeCopies(const char * copies, const BenchLine * lines, long nbrLines)
+{
+    char *  tokBegin, * tokEnd;
+    long    nbrTokens = 0;
+    long    i;
+
+    for ( i = 0; i < nbrLines; i++ )
+    {
+        for ( tokBegin = (char *) copies + lines[i].copy; ; tokBegin = tokEnd + 1 )
+        {
+            getToken(&tokBegin, &tokEnd);
+            if ( *tokBegin == '\0' )
+                break;
+            nbrTokens++;
+            if ( *tokEnd == '\0' )
+                break;
+        }
+    }
+
+    return nbrTokens;
+}
+
+/*
+ * getNTokensCopies reads every copy that has tokens with getNTokens, and
+ * returns the number of tokens read.
+ */
+static long getNTokensCopies(char * copies, const BenchLine * lines, long nbrLines)
+{
+    char *  results[MAX_TOKENS];
+    long    nbrTokens = 0;
+    long    i;
+
+    for ( i = 0; i < nbrLines; i++ )
+        if ( lines[i].nbrTokens > 0 && lines[i].nbrTokens <= MAX_TOKENS &&
+             getNTokens(copies + lines[i].copy, lines[i].nbrTokens, results) )
+            nbrTokens += lines[i].nbrTokens;
+
+    return nbrTokens;
+}
+
+/*
+ * getNTokensInPlace reads every line that has tokens with getNTokensN, and
+ * returns the number of tokens read.
+ */
+static long getNTokensInPlace(const BenchLine * lines, long nbrLines)
+{
+    TokenSpan results[MAX_TOKENS];
+    long    nbrTokens = 0;
+    long    i;
+
+    for ( i = 0; i < nbrLines; i++ )
+        if ( lines[i].nbrTokens > 0 && lines[i].nbrTokens <= MAX_TOKENS &&
+             getNTokensN(lines[i].begin, lines[i].end, lines[i].nbrTokens, results) )
+            nbrTokens += lines[i].nbrTokens;
+
+    return nbrTokens;
+}
+
+/*
+ * lookupAll looks up names[order[i]] for each of the NBR_LOOKUPS entries
+ * of order, and returns the number of lookups that found their label.
+ */
+static long lookupAll(LabelTable * table, char ** names, const int * order)
+{
+    long    found = 0;
+    int     i;
+
+    for ( i = 0; i < NBR_LOOKUPS; i++ )
+        found += findLabel(table, names[order[i]]) != -1;
+
+    return found;
+}
+
+static void report(const char * phase, const char * unit, long count, double seconds)
+{
+    printf("phase=%s unit=%s count=%ld seconds=%.6f ns_per_unit=%.1f\n",
+           phase, unit, count, seconds, count > 0 ? seconds * 1e9 / count : 0.0);
+}
+
+/* Returns the current time, in seconds, from a monotonic clock. */
+static double now(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
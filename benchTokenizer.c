@@ -0,0 +1,265 @@
+/*
+ * Benchmark of tokenizer throughput.
+ *
+ * The benchmark builds a source in memory by repeating the lines of an
+ * assembly file until it has the requested number of lines, then times
+ * the work of splitting every line into tokens in each of these ways:
+ *      isspace   -- the original getToken (chained comparisons and isspace),
+ *                   on a null-terminated copy of each line with its comment
+ *                   cut off by strtok, as pass1 and pass2 first did;
+ *      getToken  -- getToken as it is now, which classifies each character
+ *                   with one lookup in CHAR_CLASS, on the same copies;
+ *      getTokenN -- getTokenN on the lines in place, with the comment found
+ *                   by scanComment, as pass1 and pass2 do now, once for each
+ *                   version of the character scanning functions (see
+ *                   CharScan.h): scalar, SSE2, and AVX2.
+ * Each way is timed several times and the best time is reported.
+ * Results are printed one per line, as space-separated key=value pairs,
+ * e.g.:
+ *
+ *      tokenizer=getTokenN scanner=sse2 lines=2000000 bytes=71000000 tokens=9000000 seconds=0.210 MB_per_s=338.1
+ *
+ * USAGE:
+ *      benchTokenizer [ lines [ filename ] ]
+ * where lines is the number of lines to tokenize (default: 2000000), and
+ *       filename is the file whose lines are repeated (default: smallSampleTestfile.mips).
+ */
+
+#include <time.h>
+#include <ctype.h>
+
+#include "assembler.h"
+
+/* Number of times each version is timed. */
+static const int NBR_RUNS = 3;
+
+static const char * SCANNER_NAMES[] = { "scalar", "sse2", "avx2" };
+
+static double now(void);
+static char * buildSource(const char * filename, long nbrLines, size_t * size);
+static long tokenizeAll(const char * source, size_t size);
+static long tokenizeCopies(const char * source, size_t size, int original);
+static void getTokenIsspace(char ** tokBegin, char ** tokEnd);
+static void report(const char * tokenizer, const char * scanner, long nbrLines,
+                   size_t size, long nbrTokens, double seconds);
+
+int main(int argc, char * argv[])
+{
+    long       nbrLines = argc > 1 ? atol(argv[1]) : 2000000;
+    const char * filename = argc > 2 ? argv[2] : "smallSampleTestfile.mips";
+    char *     source;
+    size_t     size;
+    int        level, selected, previous = -1;
+    int        run;
+    long       nbrTokens = 0;
+    double     start, seconds, best;
+
+    if ( (source = buildSource(filename, nbrLines, &size)) == NULL )
+        return 1;
+
+    /* Null-terminated copies, with the original getToken and with the table. */
+    for ( level = 1; level >= 0; level-- )
+    {
+        best = 0;
+        for ( run = 0; run < NBR_RUNS; run++ )
+        {
+            start = now();
+            nbrTokens = tokenizeCopies(source, size, level);
+            seconds = now() - start;
+            if ( run == 0 || seconds < best )
+                best = seconds;
+        }
+        report(level ? "isspace" : "getToken", "none", nbrLines, size, nbrTokens, best);
+    }
+
+    for ( level = SCAN_SCALAR; level <= SCAN_BEST; level++ )
+    {
+        /* Skip a version the machine does not have (the one below it is selected instead). */
+        selected = scanSelect(level);
+        if ( selected == previous )
+            continue;
+        previous = selected;
+
+        best = 0;
+        for ( run = 0; run < NBR_RUNS; run++ )
+        {
+            start = now();
+            nbrTokens = tokenizeAll(source, size);
+            seconds = now() - start;
+            if ( run == 0 || seconds < best )
+                best = seconds;
+        }
+
+        report("getTokenN", SCANNER_NAMES[selected], nbrLines, size, nbrTokens, best);
+    }
+
+    free(source);
+    return 0;
+}
+
+/*
+ * buildSource returns a buffer holding nbrLines lines, taken in turn from
+ * the lines of filename, and sets *size to the number of characters in it.
+ * It returns NULL (after printing an error) if the file cannot be read.
+ */
+static char * buildSource(const char * filename, long nbrLines, size_t * size)
+{
+    FILE *     fp;
+    char       line[BUFSIZ];
+    char *     text = NULL;           /* The lines of the file, one after another. */
+    size_t     textSize = 0;
+    size_t     length;
+    char *     source;
+    size_t     offset, lineLength;
+    long       i;
+
+    if ( (fp = fopen(filename, "r")) == NULL )
+    {
+        printError("Error: Cannot open file %s.\n", filename);
+        return NULL;
+    }
+    while ( fgets(line, BUFSIZ, fp) != NULL )
+    {
+        length = strlen(line);
+        if ( (text = realloc(text, textSize + length)) == NULL )
+            break;
+        memcpy(text + textSize, line, length);
+        textSize += length;
+    }
+    (void) fclose(fp);
+
+    if ( text == NULL || textSize == 0 || text[textSize - 1] != '\n' ||
+         (source = malloc(textSize * (nbrLines + 1))) == NULL )
+    {
+        printError("Error: cannot build a source from %s.\n", filename);
+        free(text);
+        return NULL;
+    }
+
+    /* Copy the lines in turn, starting over at the top of the file as needed. */
+    *size = 0;
+    for ( i = 0, offset = 0; i < nbrLines; i++ )
+    {
+        lineLength = (char *) memchr(text + offset, '\n', textSize - offset) - (text + offset) + 1;
+        memcpy(source + *size, text + offset, lineLength);
+        *size += lineLength;
+        offset = (offset + lineLength) % textSize;
+    }
+
+    free(text);
+    return source;
+}
+
+/*
+ * tokenizeAll splits every line of source into tokens, as pass1 and pass2
+ * do, and returns the number of tokens found.
+ */
+static long tokenizeAll(const char * source, size_t size)
+{
+    const char * line, * next, * end;
+    const char * tokBegin, * tokEnd;
+    const char * sourceEnd = source + size;
+    long         nbrTokens = 0;
+
+    for ( line = source; line < sourceEnd; line = next )
+    {
+        next = memchr(line, '\n', sourceEnd - line);
+        next = next == NULL ? sourceEnd : next + 1;
+        if ( *line == '#' )
+            continue;
+        end = scanComment(line, next);
+
+        for ( tokBegin = line; tokBegin < end; tokBegin = tokEnd + 1 )
+        {
+            getTokenN(&tokBegin, &tokEnd, end);
+            if ( tokBegin == end )
+                break;
+            nbrTokens++;
+            if ( tokEnd == end )
+                break;
+        }
+    }
+
+    return nbrTokens;
+}
+
+/*
+ * tokenizeCopies splits every line of source into tokens the way pass1 and
+ * pass2 first did: copy the line into a buffer (as fgets would), cut off
+ * the comment with strtok, and call getToken until the null byte.  If
+ * original is nonzero, the original getToken is used instead of the
+ * current one.  It returns the number of tokens found.
+ */
+static long tokenizeCopies(const char * source, size_t size, int original)
+{
+    const char * line, * next;
+    const char * sourceEnd = source + size;
+    char         inst[BUFSIZ];
+    char *       tokBegin, * tokEnd;
+    size_t       length;
+    long         nbrTokens = 0;
+
+    for ( line = source; line < sourceEnd; line = next )
+    {
+        next = memchr(line, '\n', sourceEnd - line);
+        next = next == NULL ? sourceEnd : next + 1;
+        length = next - line < BUFSIZ ? (size_t) (next - line) : BUFSIZ - 1;
+        memcpy(inst, line, length);
+        inst[length] = '\0';
+        if ( *inst == '#' )
+            continue;
+        (void) strtok(inst, "#");
+
+        for ( tokBegin = inst; ; tokBegin = tokEnd + 1 )
+        {
+            if ( original )
+                getTokenIsspace(&tokBegin, &tokEnd);
+            else
+                getToken(&tokBegin, &tokEnd);
+            if ( *tokBegin == '\0' )
+                break;
+            nbrTokens++;
+            if ( *tokEnd == '\0' )
+                break;
+        }
+    }
+
+    return nbrTokens;
+}
+
+/*
+ * getTokenIsspace is getToken as it was before CHAR_CLASS, kept here
+ * to measure against.
+ */
+static void getTokenIsspace(char ** tokBegin, char ** tokEnd)
+{
+    while (**tokBegin != '\0' && isspace (**tokBegin))
+        (*tokBegin)++;
+    if ( **tokBegin == '\0' )
+    {
+        *tokEnd = *tokBegin;
+        return;
+    }
+
+    *tokEnd = *tokBegin + 1;
+    while (**tokEnd != '\0' && **tokEnd != ',' &&
+           **tokEnd != '(' && **tokEnd != ')' && **tokEnd != ':' &&
+           !isspace (**tokEnd))
+        (*tokEnd)++;
+}
+
+static void report(const char * tokenizer, const char * scanner, long nbrLines,
+                   size_t size, long nbrTokens, double seconds)
+{
+    printf("tokenizer=%s scanner=%s lines=%ld bytes=%lu tokens=%ld seconds=%.6f MB_per_s=%.1f\n",
+           tokenizer, scanner, nbrLines, (unsigned long) size, nbrTokens,
+           seconds, size / seconds / 1e6);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,197 @@
+/*
+ * Generator of synthetic assembly sources for the benchmarks.
+ *
+ * genSource writes a MIPS assembly source of the requested shape to
+ * stdout.  Every line holds an instruction, except for the comment lines
+ * asked for, so that the assembler reads a valid program of any size:
+ *      labels   -- the given percentage of lines begin with a label; the
+ *                  labels are spread evenly through the source;
+ *      comments -- the given percentage of lines carry a comment; one in
+ *                  four of them is a line of its own, the others follow
+ *                  an instruction;
+ *      fan-out  -- the average number of branches and jumps that refer to
+ *                  each label; three in four are conditional branches to
+ *                  one of the labels nearby (within BRANCH_REACH labels),
+ *                  the others jumps to any label in the source;
+ *      name length -- the number of characters in each label name (names
+ *                  are letters followed by the label's number, so they
+ *                  are never shorter than the number needs).
+ * The choices are made by a pseudo-random generator with a fixed seed
+ * (which can be changed), so the same options always produce the same
+ * source.
+ *
+ * USAGE:
+ *      genSource [-n lines] [-l labels] [-c comments] [-f fanout] [-w length] [-s seed]
+ * where lines is the number of lines to write (default: 1000000),
+ *       labels is the percentage of lines with a label (default: 6),
+ *       comments is the percentage of lines with a comment (default: 10),
+ *       fanout is the number of references to each label (default: 2),
+ *       length is the number of characters in a label name (default: 8), and
+ *       seed is the seed of the pseudo-random choices (default: 1).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Branches go to labels at most this many labels away. */
+static const long BRANCH_REACH = 8;
+
+/* Longest label name written. */
+#define MAX_NAME_LENGTH 64
+
+/* Instructions without a label operand, chosen from at random. */
+static const char * PLAIN[] = {
+    "add $t0, $t1, $t2",
+    "sub $s0, $s1, $t3",
+    "lw $a0, 4($sp)",
+    "sw $ra, 0($sp)",
+    "addi $t0, $t0, -1",
+    "ori $t4, $zero, 0x7f",
+    "slt $t2, $a0, $t1",
+    "sll $t3, $t3, 2",
+    "and $v0, $a1, $a2",
+    "jr $ra",
+};
+
+/* Comments, chosen from at random. */
+static const char * COMMENTS[] = {
+    "# count down",
+    "# save the return address",
+    "# load the next element of the array",
+    "# i++",
+    "# done?",
+    "# compute the address of a[i] from the base address and the index",
+};
+
+static unsigned long long seed = 1;
+
+static unsigned long nextRandom(void);
+static int chance(double percent);
+static void labelName(char * name, long labelNbr, int length);
+
+int main(int argc, char * argv[])
+{
+    long    nbrLines = 1000000;
+    double  labelPercent = 6;
+    double  commentPercent = 10;
+    double  fanout = 2;
+    int     nameLength = 8;
+    long    nbrLabels;           /* Number of labels in the source. */
+    long    nextLabel = 0;       /* Number of the next label to place. */
+    long    target;              /* Number of a branch's or jump's label. */
+    double  referencePercent;    /* Percentage of the other lines that refer to a label. */
+    char    name[MAX_NAME_LENGTH + 1];
+    long    i;
+    int     option;
+
+    while ( (option = getopt(argc, argv, "n:l:c:f:w:s:")) != -1 )
+    {
+        switch ( option )
+        {
+            case 'n': nbrLines = atol(optarg); break;
+            case 'l': labelPercent = atof(optarg); break;
+            case 'c': commentPercent = atof(optarg); break;
+            case 'f': fanout = atof(optarg); break;
+            case 'w': nameLength = atoi(optarg); break;
+            case 's': seed = strtoull(optarg, NULL, 10); break;
+            default:
+                fprintf(stderr, "Usage: %s [-n lines] [-l labels] [-c comments] "
+                        "[-f fanout] [-w length] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+    if ( nbrLines < 0 || labelPercent < 0 || labelPercent > 100 || commentPercent < 0 ||
+         commentPercent > 100 || fanout < 0 || nameLength < 2 || nameLength > MAX_NAME_LENGTH )
+    {
+        fprintf(stderr, "%s: an option is out of range.\n", argv[0]);
+        return 1;
+    }
+
+    nbrLabels = (long) (nbrLines * labelPercent / 100);
+    referencePercent = nbrLines > nbrLabels ? 100.0 * nbrLabels * fanout / (nbrLines - nbrLabels) : 0;
+
+    for ( i = 0; i < nbrLines; i++ )
+    {
+        /* Label number k goes on line k * nbrLines / nbrLabels. */
+        if ( nextLabel < nbrLabels && i == nextLabel * nbrLines / nbrLabels )
+        {
+            labelName(name, nextLabel++, nameLength);
+            printf("%s: ", name);
+        }
+        else if ( chance(commentPercent / 4) )
+        {
+            printf("%s\n", COMMENTS[nextRandom() % (sizeof(COMMENTS) / sizeof(COMMENTS[0]))]);
+            continue;
+        }
+        else
+            fputs("    ", stdout);
+
+        if ( nbrLabels > 0 && chance(referencePercent) )
+        {
+            if ( nextRandom() % 4 != 0 )
+            {
+                /* A branch to one of the labels around this line. */
+                target = nextLabel - 1 - BRANCH_REACH + (long) (nextRandom() % (2 * BRANCH_REACH + 1));
+                target = target < 0 ? 0 : target >= nbrLabels ? nbrLabels - 1 : target;
+                labelName(name, target, nameLength);
+                printf("%s $t0, $t1, %s", nextRandom() % 2 ? "beq" : "bne", name);
+            }
+            else
+            {
+                labelName(name, (long) (nextRandom() % nbrLabels), nameLength);
+                printf("%s %s", nextRandom() % 2 ? "j" : "jal", name);
+            }
+        }
+        else
+            fputs(PLAIN[nextRandom() % (sizeof(PLAIN) / sizeof(PLAIN[0]))], stdout);
+
+        /* Three in four comments follow an instruction. */
+        if ( chance(commentPercent * 3 / 4) )
+            printf("    %s", COMMENTS[nextRandom() % (sizeof(COMMENTS) / sizeof(COMMENTS[0]))]);
+        putchar('\n');
+    }
+
+    if ( fflush(stdout) != 0 || ferror(stdout) )
+    {
+        fprintf(stderr, "%s: cannot write the source.\n", argv[0]);
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * labelName writes the name of label number labelNbr into name: letters
+ * that depend on the number, then the number itself, length characters
+ * in all (or more, if the number needs them).  Since the letters never
+ * run into the digits, no two labels get the same name.
+ */
+static void labelName(char * name, long labelNbr, int length)
+{
+    char     digits[24];
+    int      nbrDigits = sprintf(digits, "%ld", labelNbr);
+    int      nbrLetters = length - nbrDigits < 1 ? 1 : length - nbrDigits;
+    unsigned long hash = (unsigned long) labelNbr * 2654435761u;
+    int      i;
+
+    for ( i = 0; i < nbrLetters; i++ )
+    {
+        name[i] = 'a' + hash % 26;
+        hash = hash / 26 + (unsigned long) (i + 1) * 40503u;
+    }
+    strcpy(name + nbrLetters, digits);
+}
+
+/* Returns 1 the given percentage of the time. */
+static int chance(double percent)
+{
+    return nextRandom() % 1000000 < percent * 10000;
+}
+
+/* Returns the next number from a 64-bit linear congruential generator. */
+static unsigned long nextRandom(void)
+{
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    return (unsigned long) (seed >> 33);
+}
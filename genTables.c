@@ -0,0 +1,172 @@
+/*
+ * genTables: generates the perfect-hash lookup tables for InstructionSet.c
+ *
+ * This program reads the instructions and registers listed in
+ * InstructionList.h and writes InstructionTables.h to the standard
+ * output.  For each table it searches for a multiplier that sends every
+ * name's key (see packName in InstructionSet.h) to a different slot,
+ * taking the top bits of key * multiplier as the slot number, and trying
+ * the smallest power-of-2 table size first.  The search is repeatable:
+ * the candidate multipliers come from a fixed pseudo-random sequence, so
+ * the same list always gives the same tables.
+ *
+ * USAGE:
+ *      genTables > InstructionTables.h
+ * (The Makefile does this before compiling InstructionSet.c.)
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "InstructionSet.h"
+
+/* Number of multipliers tried for each table size before trying a larger size. */
+#define MAX_TRIES 1000000
+
+/* Largest table size tried, as a power of 2. */
+#define MAX_BITS 12
+
+typedef struct {
+        const char * name;
+        const char * format;
+        unsigned     opcode;
+        unsigned     funct;
+        int          number;
+        uint64_t     key;
+} Entry;
+
+/* The list, as read from InstructionList.h. */
+#define INSTRUCTION(name, format, opcode, funct) { name, #format, opcode, funct, 0, 0 },
+#define REGISTER(name, number)
+static Entry INSTRUCTIONS[] = {
+#include "InstructionList.h"
+};
+#undef INSTRUCTION
+#undef REGISTER
+
+#define INSTRUCTION(name, format, opcode, funct)
+#define REGISTER(name, number) { name, NULL, 0, 0, number, 0 },
+static Entry REGISTERS[] = {
+#include "InstructionList.h"
+};
+#undef INSTRUCTION
+#undef REGISTER
+
+static uint64_t nextRandom (uint64_t * state);
+static int findMultiplier (Entry * entries, int n, uint64_t * multiplier, int * bits, int * slots);
+static int emitTable (Entry * entries, int n, const char * prefix, int isInstruction);
+
+int main (void)
+{
+        printf ("/*\n"
+                " * Perfect-hash tables for InstructionSet.c, generated by genTables\n"
+                " * from InstructionList.h.  Do not edit this file; edit the list instead.\n"
+                " */\n\n");
+
+        if ( ! emitTable (INSTRUCTIONS, sizeof INSTRUCTIONS / sizeof *INSTRUCTIONS, "MNEMONIC", 1) ||
+             ! emitTable (REGISTERS, sizeof REGISTERS / sizeof *REGISTERS, "REGISTER", 0) )
+            return 1;
+        return 0;
+}
+
+static int emitTable (Entry * entries, int n, const char * prefix, int isInstruction)
+  /* Prints the table for the given entries, or returns 0 (after printing an error) if it cannot. */
+{
+        uint64_t multiplier;
+        int      bits;
+        int *    slots = malloc (sizeof(int) << MAX_BITS);
+        int      i, j;
+
+        if ( slots == NULL )
+            return 0;
+
+        for ( i = 0; i < n; i++ )
+        {
+            entries[i].key = packName (entries[i].name, strlen (entries[i].name));
+            if ( entries[i].key == 0 )
+            {
+                fprintf (stderr, "genTables: name %s is too long.\n", entries[i].name);
+                free (slots);
+                return 0;
+            }
+            for ( j = 0; j < i; j++ )
+                if ( entries[j].key == entries[i].key )
+                {
+                    fprintf (stderr, "genTables: name %s is listed twice.\n", entries[i].name);
+                    free (slots);
+                    return 0;
+                }
+        }
+
+        if ( ! findMultiplier (entries, n, &multiplier, &bits, slots) )
+        {
+            fprintf (stderr, "genTables: no perfect hash found for the %s table.\n", prefix);
+            free (slots);
+            return 0;
+        }
+
+        printf ("#define %s_MULTIPLIER 0x%016llxULL\n", prefix, (unsigned long long) multiplier);
+        printf ("#define %s_SHIFT      %d\n", prefix, 64 - bits);
+        printf ("#define %s_SLOTS      %d\n\n", prefix, 1 << bits);
+        printf ("static const %s %s_TABLE[%s_SLOTS] = {\n",
+                isInstruction ? "Mnemonic" : "RegisterName", prefix, prefix);
+        for ( i = 0; i < (1 << bits); i++ )
+        {
+            if ( slots[i] == -1 )
+                continue;
+            j = slots[i];
+            if ( isInstruction )
+                printf ("        [%3d] = { 0x%016llxULL, \"%s\", %s, 0x%02x, 0x%02x },\n",
+                        i, (unsigned long long) entries[j].key, entries[j].name,
+                        entries[j].format, entries[j].opcode, entries[j].funct);
+            else
+                printf ("        [%3d] = { 0x%016llxULL, %d },   /* %s */\n",
+                        i, (unsigned long long) entries[j].key, entries[j].number, entries[j].name);
+        }
+        printf ("};\n\n");
+
+        free (slots);
+        return 1;
+}
+
+static int findMultiplier (Entry * entries, int n, uint64_t * multiplier, int * bits, int * slots)
+  /* Postcondition: If 1 is returned, the top *bits bits of key * *multiplier differ for every entry,
+   *                  and slots[s] is the entry in slot s (or -1 for an empty slot).
+   */
+{
+        uint64_t state = 0x243f6a8885a308d3ULL;    /* Fixed, so the tables are repeatable. */
+        int      tries, i, slot;
+
+        for ( *bits = 1; (1 << *bits) < n; (*bits)++ )
+            ;
+        for ( ; *bits <= MAX_BITS; (*bits)++ )
+            for ( tries = 0; tries < MAX_TRIES; tries++ )
+            {
+                *multiplier = nextRandom (&state) | 1;
+                for ( i = 0; i < (1 << *bits); i++ )
+                    slots[i] = -1;
+                for ( i = 0; i < n; i++ )
+                {
+                    slot = (int) ((entries[i].key * *multiplier) >> (64 - *bits));
+                    if ( slots[slot] != -1 )
+                        break;
+                    slots[slot] = i;
+                }
+                if ( i == n )
+                    return 1;
+            }
+
+        return 0;
+}
+
+static uint64_t nextRandom (uint64_t * state)
+  /* Returns the next number in the splitmix64 sequence. */
+{
+        uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+}
@@ -27,6 +27,11 @@
  *
  * The getNTokens function uses the getToken function.
  *
+ * getNTokensN does the same without changing the string: it reads the
+ * tokens between two pointers into an array of token spans (see
+ * getToken.h), each of which gives the token's beginning, length, and
+ * kind, in one pass over the characters.  It uses getTokenSpan.
+ *
  * See getNTokens.h for more specific information about how getNTokens behaves and for an example.
  *
  * Author:          Alyce Brady
@@ -38,6 +43,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "getToken.h"
 
@@ -136,3 +142,53 @@ int getNTokens (char * instructionBuffer, int N, char * results[])
     return 1;
 }
 
+/**
+ * getNTokensN -- Read N tokens from begin..end, putting spans that describe
+ *                the tokens in results
+ *
+ * Parameters:  begin, end -- the characters containing tokens (not necessarily null-terminated)
+ *              N          -- the expected number of tokens
+ *              results    -- an array of token spans
+ *
+ * Precondition: begin <= end &&
+ *               N >= 1 &&
+ *               results is a valid pointer to an array containing space for at least N token spans
+ *
+ * Postcondition: If begin..end contains N tokens,
+ *                   results is filled with spans, one for each of those tokens, and
+ *                   getNTokensN returns 1.
+ *                If begin..end contains fewer or more than N tokens,
+ *                   getNTokensN returns 0 and
+ *                   puts a pointer to an appropriate error message in results[0].begin
+ *                   (and its length in results[0].length).
+ *                The characters are not changed.
+ */
+int getNTokensN (const char * begin, const char * end, int N, TokenSpan results[])
+{
+    int i;
+    TokenSpan extra;
+
+    if ( begin == NULL || N < 1 || results == NULL )
+        return 0;
+
+    /* Get the expected tokens. */
+    for ( i = 0; i < N; i++ )
+        if ( ! getTokenSpan (&begin, end, &results[i]) )
+        {
+            /* Token expected, but no token found. */
+            results[0].begin = TOO_FEW;
+            results[0].length = strlen (TOO_FEW);
+            return 0;
+        }
+
+    /* Have found all expected tokens.  Is there another one? */
+    if ( getTokenSpan (&begin, end, &extra) )
+    {
+        /* No token expected, but one is found. */
+        results[0].begin = TOO_MANY;
+        results[0].length = strlen (TOO_MANY);
+        return 0;
+    }
+
+    return 1;
+}
@@ -17,7 +17,12 @@
  */
 
 #include <stdio.h>
-#include <ctype.h>
+
+#include "getToken.h"
+#include "CharScan.h"
+
+/* Number of characters getTokenN examines one at a time before scanning by blocks. */
+#define SHORT_RUN 16
 
 void getToken (char ** tokBegin, char ** tokEnd)
   /* Postconditions: If tokBegin or *tokBegin was NULL when getToken was called,
@@ -33,8 +38,8 @@ void getToken (char ** tokBegin, char ** tokEnd)
         if ( tokBegin == NULL || *tokBegin == NULL )
             return;
 
-        /* Skip any leading whitespace. */
-        while (**tokBegin != '\0' && isspace (**tokBegin))
+        /* Skip any leading whitespace (see CHAR_CLASS in CharScan.h). */
+        while ( CHAR_CLASS[(unsigned char) **tokBegin] & CHAR_SPACE )
             (*tokBegin)++;
         if ( **tokBegin == '\0' )
         {
@@ -42,11 +47,9 @@ void getToken (char ** tokBegin, char ** tokEnd)
             return;
         }
 
-        /* Find the end of the first token. */
+        /* Find the end of the first token: the first delimiter or null byte. */
         *tokEnd = *tokBegin + 1;
-        while (**tokEnd != '\0' && **tokEnd != ',' &&
-               **tokEnd != '(' && **tokEnd != ')' && **tokEnd != ':' &&
-               !isspace (**tokEnd))
+        while ( ! (CHAR_CLASS[(unsigned char) **tokEnd] & (CHAR_DELIMITER | CHAR_NUL)) )
             (*tokEnd)++;
 
         /* (*tokBegin) now points to beginning of token;
@@ -54,3 +57,80 @@ void getToken (char ** tokBegin, char ** tokEnd)
          */
 }
 
+void getTokenN (const char ** tokBegin, const char ** tokEnd, const char * end)
+  /* Postconditions: Same as getToken, but the string ends at end rather than at a null byte.
+   *                 If there is no token, *tokBegin and *tokEnd point to end.
+   */
+{
+        const char * limit;        /* End of the characters looked at one at a time. */
+
+        /* Make sure that we have a string to step through. */
+        if ( tokBegin == NULL || *tokBegin == NULL )
+            return;
+
+        /* Skip any leading whitespace.  Most gaps and tokens are only a few characters
+         *  long, so look at the first few characters one at a time (see CHAR_CLASS in
+         *  CharScan.h), and only hand a longer run to the block scanners.
+         */
+        limit = end - *tokBegin > SHORT_RUN ? *tokBegin + SHORT_RUN : end;
+        while ( *tokBegin < limit && (CHAR_CLASS[(unsigned char) **tokBegin] & CHAR_SPACE) )
+            (*tokBegin)++;
+        if ( *tokBegin == limit && limit != end )
+            *tokBegin = scanSpaces (*tokBegin, end);
+        if ( *tokBegin == end )
+        {
+            *tokEnd = *tokBegin;
+            return;
+        }
+
+        /* Find the end of the first token, the same way. */
+        *tokEnd = *tokBegin + 1;
+        limit = end - *tokEnd > SHORT_RUN ? *tokEnd + SHORT_RUN : end;
+        while ( *tokEnd < limit && ! (CHAR_CLASS[(unsigned char) **tokEnd] & CHAR_DELIMITER) )
+            (*tokEnd)++;
+        if ( *tokEnd == limit && limit != end )
+            *tokEnd = scanDelimiter (*tokEnd, end);
+
+        /* (*tokBegin) now points to beginning of token;
+         * (*tokEnd) now points to 1st character AFTER token.
+         */
+}
+
+int getTokenSpan (const char ** next, const char * end, TokenSpan * span)
+  /* Postconditions: If there is a token at or after *next, span describes it,
+   *                  *next points past the delimiter after it, and 1 is returned;
+   *                 otherwise, *next points to end and 0 is returned.
+   */
+{
+        const char * tokBegin = *next;
+        const char * tokEnd;
+        unsigned char class;        /* Class of the token's first character. */
+
+        /* The delimiter after the last token may have been the last character. */
+        if ( tokBegin >= end )
+        {
+            *next = end;
+            return 0;
+        }
+
+        getTokenN (&tokBegin, &tokEnd, end);
+        if ( tokBegin == end )
+        {
+            *next = end;
+            return 0;
+        }
+
+        /* Tell the kind of token from its first character, and the delimiter after it. */
+        class = CHAR_CLASS[(unsigned char) *tokBegin];
+        if ( class & CHAR_DOLLAR )
+            span->kind = TOKEN_REGISTER;
+        else if ( class & CHAR_NUMBER )
+            span->kind = (tokEnd != end && *tokEnd == '(') ? TOKEN_MEMORY : TOKEN_IMMEDIATE;
+        else
+            span->kind = TOKEN_LABEL;
+        span->begin = tokBegin;
+        span->length = tokEnd - tokBegin;
+
+        *next = tokEnd == end ? end : tokEnd + 1;
+        return 1;
+}
@@ -81,6 +81,59 @@
 #ifndef _GETTOKEN_H
 #define _GETTOKEN_H
 
+#include <stddef.h>
+
 void getToken (char ** tokBegin, char ** tokEnd);
 
+/*
+ * void getTokenN (const char ** tokBegin, const char ** tokEnd, const char * end)
+ *   getTokenN behaves exactly like getToken, except that the string it steps
+ *   through ends at end rather than at a null byte.  This lets the caller
+ *   tokenize a line that is not null-terminated, such as a line view into a
+ *   mapped file.
+ *   Postconditions: If tokBegin or *tokBegin was NULL, they are unchanged;
+ *                   if there is no token before end,
+ *                    both *tokBegin and *tokEnd point to end;
+ *                   otherwise,
+ *                    *tokBegin points to the first character in the next token and
+ *                    *tokEnd points to the first character AFTER the token (possibly end).
+ *   The calling function should check that *tokBegin != end before assuming that it
+ *   points to a valid token, and that *tokEnd != end before examining *tokEnd.
+ */
+void getTokenN (const char ** tokBegin, const char ** tokEnd, const char * end);
+
+/*
+ * A token span describes a token in place: where it begins, how long it
+ * is, and what kind of operand it looks like, judging by its first
+ * character and the delimiter after it:
+ *      TOKEN_REGISTER  -- begins with '$' (e.g., $t0);
+ *      TOKEN_IMMEDIATE -- begins with a digit or sign (e.g., 0, -4);
+ *      TOKEN_MEMORY    -- an immediate followed by a left parenthesis, i.e.,
+ *                         the offset of a memory operand (e.g., the 0 in
+ *                         0($t0)); the base register is the next token;
+ *      TOKEN_LABEL     -- anything else, i.e., a name (e.g., loop, or an
+ *                         instruction name such as add).
+ */
+#define TOKEN_REGISTER   0
+#define TOKEN_IMMEDIATE  1
+#define TOKEN_MEMORY     2
+#define TOKEN_LABEL      3
+
+typedef struct {
+        const char * begin;     /* First character of the token. */
+        size_t length;          /* Number of characters in the token. */
+        int    kind;            /* TOKEN_REGISTER, TOKEN_IMMEDIATE, TOKEN_MEMORY, or TOKEN_LABEL. */
+} TokenSpan;
+
+/*
+ * int getTokenSpan (const char ** next, const char * end, TokenSpan * span)
+ *   getTokenSpan finds the next token at or after *next and before end, as
+ *   getTokenN does, and describes it in span.  It then moves *next past the
+ *   delimiter after the token, so that calling it again finds the token
+ *   after that.  Nothing is written into the string.
+ *   Returns 1 if a token was found;
+ *           0 if there are no more tokens before end (span is unchanged).
+ */
+int getTokenSpan (const char ** next, const char * end, TokenSpan * span);
+
 #endif
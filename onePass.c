@@ -0,0 +1,134 @@
+/**
+ * LabelTable onePass (SourceFile * source, WordBuffer * words)
+ *      @param  source  an opened source file from which to read lines
+ *                      of assembly source code
+ *      @param  words   an empty word buffer to hold the encoded instructions
+ *      @return a newly-created table containing labels found in the
+ *              input, each with the address of the instruction
+ *              containing it (assuming the first line of input
+ *              corresponds to address 0)
+ *
+ * This function does the work of pass1 and pass2 in a single pass over
+ * the input, so that each line is read and tokenized exactly once.
+ * Labels are added to the table as they are found, and each instruction
+ * is encoded into words as soon as it is read.  An instruction that
+ * refers to a label that has not been defined yet is emitted with its
+ * label field left as zero, and a fixup is recorded; when the label is
+ * defined, the fixups waiting for it are patched (see Fixups.h).  Labels
+ * that are never defined are reported once the whole input has been read.
+ *
+ * The words are left in the buffer rather than printed, since a word may
+ * not be complete until the end of the input.
+ *
+ * int onePassLabel (LabelTable * table, FixupList * fixups,
+ *                   const char * labelBegin, size_t length, int PC,
+ *                   WordBuffer * words)
+ * int onePassLine (const TokenStream * stream, const TokenLine * line,
+ *                  LabelTable * table, FixupList * fixups, WordBuffer * words)
+ *      Do onePass's work for a label and for an instruction line that has
+ *      been recorded in a token stream, respectively, so that the pipelined
+ *      assembler (see pipeline.c) can do the same work on lines that were
+ *      split into tokens by another thread.  onePassLine returns 0 if
+ *      memory ran out, and 1 otherwise.
+ *
+ */
+
+#include "assembler.h"
+
+LabelTable onePass (SourceFile * source, WordBuffer * words)
+  /* Returns a copy of the label table that was constructed. */
+{
+    LabelTable table;              /* The table of labels and addresses. */
+    FixupList fixups;              /* References to labels not defined yet. */
+    int    lineNum;                /* Line number. */
+    int    PC;                     /* Program counter (PC). */
+    LineView line;                 /* The current line (not null-terminated). */
+    LineView label;                /* The line's label, if it has one. */
+    TokenStream stream;            /* Tokens of the current line only. */
+    int    status;                 /* 0 if memory ran out on the line. */
+
+    /* Create a label table about the size the source needs to begin with (see pass1.c). */
+    tableInit (&table);
+    fixupInit (&fixups);
+    streamInit (&stream);
+	/* Resize table and check whether an error occurred while attempting to resize. */
+    if ( tableResize (&table, pass1EstimateLabels (source)) == 0)
+    {
+        /* Error message already printed. An error message is printed to the standard error by tableResize. */
+        return table;
+    }
+
+    /* Continuously read next line of input until EOF is encountered.*/
+    for (lineNum = 1, PC = 0; sourceNextLine (source, &line); lineNum++, PC += 4)
+    {
+        /* Split the line into its label and its instruction's tokens,
+         *  reusing the stream's memory from line to line.
+         */
+        streamClear (&stream);
+        status = pass1Line (&line, lineNum, PC, &label, &stream);
+
+        /* If the line has a label, add it to the table and patch any words waiting for it. */
+        if ( label.begin != NULL )
+            (void) onePassLabel (&table, &fixups, label.begin, label.length, PC, words);
+
+        if ( status == 0 )
+            break;                  /* FATAL ERROR: Couldn't allocate memory. */
+
+        /* Encode the instruction, if the line has one. */
+        if ( stream.nbrLines == 1 && onePassLine (&stream, &stream.lines[0], &table, &fixups, words) == 0 )
+            break;                  /* FATAL ERROR: Couldn't allocate memory. */
+    }
+
+    /* Any label still awaited was never defined. */
+    (void) fixupReportUnresolved (&fixups);
+    fixupDestroy (&fixups);
+    streamDestroy (&stream);
+
+    /* EOF, but don't close the file here. */
+    return table;
+}
+
+int onePassLabel (LabelTable * table, FixupList * fixups, const char * labelBegin, size_t length,
+                  int PC, WordBuffer * words)
+  /* Adds a label to the table and patches any words waiting for it.
+   * Returns the number of words patched.
+   */
+{
+    if ( addLabelN (table, labelBegin, length, PC) == 0 )
+        return 0;                   /* Error message already printed by addLabelN. */
+    return fixupResolve (fixups, labelBegin, length, PC, words);
+}
+
+int onePassLine (const TokenStream * stream, const TokenLine * line, LabelTable * table,
+                 FixupList * fixups, WordBuffer * words)
+  /* Encodes a recorded instruction line into words, patching in its label or recording a fixup for it.
+   * Returns 1 if everything went OK (or the instruction had errors, which were reported,
+   *           and a nop took its place);
+   *         0 if memory allocation error.
+   */
+{
+    uint32_t word;                 /* Encoded instruction. */
+    LabelRef ref;                  /* Label operand of the instruction, if any. */
+    int    address;                /* Address of the label operand. */
+
+    /* Encode the instruction.  If it has errors (already reported), it is a nop instead,
+     *  so that the words after it stay at their addresses.
+     */
+    (void) encodeTokens (stream, line, &word, &ref);
+
+    /* Patch in a label that is already defined; otherwise record a fixup for this word. */
+    if ( ref.use != LABEL_NONE )
+    {
+        address = findLabelN (table, ref.begin, ref.length);
+        if ( address != -1 )
+        {
+            if ( patchLabel (&word, ref.use, address, line->PC) == 0 )
+                printError ("Error on line %d: branch target %.*s is out of range.\n",
+                            line->lineNum, (int) ref.length, ref.begin);
+        }
+        else if ( fixupAdd (fixups, &ref, words->nbrWords, line->PC, line->lineNum) == 0 )
+            return 0;               /* FATAL ERROR: Couldn't allocate memory. */
+    }
+
+    return wordsAppend (words, word);
+}
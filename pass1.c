@@ -22,22 +22,129 @@
  * Modified by:  Torey Halsey, 6/5/2018
  *      Editted comments.
  *
+ * LabelTable pass1Source (SourceFile * source)
+ *      Does the same, reading the lines of an opened source file, which
+ *      may be a memory mapping of the input (see SourceFile.h).  pass1
+ *      reads fp through stdio by way of pass1Source.
+ *
+ * LabelTable pass1Tokenize (SourceFile * source, TokenStream * stream)
+ *      Does the same, and also records the tokens of every instruction
+ *      line in stream (see TokenStream.h), so that pass2Tokens can encode
+ *      the instructions without reading or scanning the input again.
+ *      pass1Source is pass1Tokenize without a stream.
+ *
+ * LabelTable pass1Parallel (SourceFile * source, TokenStream * stream,
+ *                           int nbrThreads)
+ *      Does the same as pass1Tokenize, on nbrThreads threads.  Every line
+ *      moves the PC on by 4, so the only thing a line needs from the lines
+ *      before it is how many there were.  The mapped input is split into
+ *      chunks at newlines; each thread counts the lines of a chunk, and
+ *      collects its labels and instructions with line numbers and addresses
+ *      counted from the start of the chunk.  A prefix sum of the chunks'
+ *      line counts then gives each chunk its first line number and address,
+ *      and the chunks' labels and instructions are added to the table and
+ *      the stream in order, so duplicate labels are reported (by addLabelN)
+ *      just as pass1Tokenize reports them.  A source read through stdio
+ *      (see SourceFile.h) is handled by pass1Tokenize.
+ *
+ * int pass1Line (const LineView * line, int lineNum, int PC,
+ *                LineView * label, TokenStream * stream)
+ *      Does pass1's work on a single line: finds its label, if it has one,
+ *      and adds its instruction's tokens, if it has an instruction, to
+ *      stream (unless stream is NULL).  The line's label is not added to a
+ *      table; label describes it instead (label->begin is NULL if the line
+ *      has no label).  Returns 0 if memory ran out, and 1 otherwise.  The
+ *      one-pass and pipelined assemblers split their lines with it too.
+ *
+ * int pass1EstimateLabels (const SourceFile * source)
+ *      Returns the number of labels to size a new label table for, so that
+ *      reading a large source does not resize the table over and over.
+ *      A mapped source's unread bytes are searched for colons (every label
+ *      ends in one, so this is an overestimate only by the colons in
+ *      comments); for a source read through stdio, the estimate is taken
+ *      from the size of the file, if it is a regular file.  The estimate is
+ *      never less than MIN_LABEL_ESTIMATE.
+ *
  */
 
+#include <pthread.h>
+#include <sys/stat.h>
+
 #include "assembler.h"
 
+/* Number of chunks pass1Parallel splits the input into, per thread. */
+#define CHUNKS_PER_THREAD 4
+
+/* Smallest input, in bytes, worth splitting among threads. */
+#define MIN_PARALLEL_SIZE 65536
+
+/* Bounds on pass1EstimateLabels, and the bytes per label it assumes for a file it cannot scan. */
+#define MIN_LABEL_ESTIMATE 10
+#define MAX_LABEL_ESTIMATE (1 << 20)
+#define BYTES_PER_LABEL    256
+
+/* A label found in a chunk by pass1Parallel, and its address from the start of the chunk. */
+typedef struct {
+    const char * begin;
+    size_t      length;
+    int         PC;
+} ChunkLabel;
+
+/* One chunk of the input for pass1Parallel, and what was found in it. */
+typedef struct {
+    const char * begin;            /* First character of the chunk (the start of a line). */
+    const char * end;              /* Just past the chunk's last newline (or the end of the input). */
+    int         nbrLines;          /* Number of lines in the chunk. */
+    int         nbrLabels;
+    int         labelsCapacity;
+    ChunkLabel * labels;           /* The chunk's labels, in order. */
+    TokenStream stream;            /* The chunk's instructions. */
+    int         failed;            /* Set if memory ran out; the chunk stops at that line. */
+} Pass1Chunk;
+
+/* The work shared by the threads of pass1Parallel. */
+typedef struct {
+    Pass1Chunk *    chunks;
+    int             nbrChunks;
+    int             nextChunk;     /* Next chunk no thread has taken yet. */
+    pthread_mutex_t lock;          /* Protects nextChunk. */
+} Pass1Work;
+
+/* Internal functions (visible to this file only). */
+static void * pass1Worker (void * work);
+static void scanChunk (Pass1Chunk * chunk);
+
 LabelTable pass1 (FILE * fp)
   /* Returns a copy of the label table that was constructed. */
+{
+    SourceFile source;             /* Reads the lines of fp with fgets. */
+
+    sourceOpen (&source, fp, 0);
+    return pass1Source (&source);
+}
+
+LabelTable pass1Source (SourceFile * source)
+  /* Returns a copy of the label table that was constructed from the lines of source. */
+{
+    return pass1Tokenize (source, NULL);
+}
+
+LabelTable pass1Tokenize (SourceFile * source, TokenStream * stream)
+  /* Returns a copy of the label table that was constructed from the lines of source;
+   *  if stream is not NULL, the tokens of each instruction are added to it.
+   */
 {
     LabelTable table;              /* The table of labels and addresses. */
+    int    lineNum;                /* Line number. */
     int    PC = 0;                 /* The program counter. */
-    char * tokBegin, * tokEnd;     /* Used to step through instruction. */
-    char   inst[BUFSIZ];           /* Will hold instruction; BUFSIZ is max size of I/O buffer (defined in stdio.h). */
+    LineView line;                 /* The current line (not null-terminated). */
+    LineView label;                /* The line's label, if it has one. */
+    int    status;                 /* 0 if memory ran out on the line. */
 
-    /* Create a small label table to begin with. */
+    /* Create a label table about the size the source needs to begin with. */
     tableInit (&table);
 	/* Resize table and check whether an error occurred while attempting to resize. */
-    if ( tableResize (&table, 10) == 0)
+    if ( tableResize (&table, pass1EstimateLabels (source)) == 0)
     {
         /* Error message already printed. An error message is printed to the standard error by tableResize. */
         return table;
@@ -46,36 +153,292 @@ LabelTable pass1 (FILE * fp)
     /* Continuously read next line of input until EOF is encountered.
      * Check each line to see if it has a label; if it does, add it to the label table.
      */
-    for (PC = 0; fgets (inst, BUFSIZ, fp); PC += 4)
+    for (lineNum = 1, PC = 0; sourceNextLine (source, &line); lineNum++, PC += 4)
     {
-        /* If the line starts with a comment, move on to next line.
-         * If there's a comment later in the line, strip it off (replace the '#' with a null byte).
+        status = pass1Line (&line, lineNum, PC, &label, stream);
+
+        /* If the line has a label, add it to the table straight from the line, by its beginning and length,
+         *  and check whether an error occurred while attempting to add the label.
          */
-        if ( *inst == '#' ) continue;
-        (void) strtok (inst, "#");
-
-        /* Read the first token, skipping any leading whitespace. */
-        tokBegin = inst;
-        getToken (&tokBegin, &tokEnd);
-            /* tokBegin now points to 1st non-whitespace character in the token;
-			 * tokEnd points to 1st punctuation mark or whitespace after the end of the token.
-             */
-
-        /* Check each line to see if it has a label; if it does, process it. */
-        if ( *(tokEnd) == ':' )
+        if ( label.begin != NULL && addLabelN (&table, label.begin, label.length, PC) == 0 )
         {
-            /* Line has a label. */
-            *tokEnd = '\0';      /* Truncate everything after label. */
+            /* Error message already printed.  An error message is printed to the standard error by addLabel. */
+        }
+
+        if ( status == 0 )
+            break;                  /* FATAL ERROR: Couldn't allocate memory. */
+    }
+
+    /* The table is read-only from here on, so give it a single-probe layout for pass2.
+     *      If no perfect hash is found, lookups still go through the ordinary hash index.
+     */
+    (void) tableFreeze (&table);
 
-            /* Add label to table and check whether an error occurring while attempting to add the label. */
-            if (addLabel (&table, tokBegin, PC) == 0)
+    /* EOF, but don't close the file here. */
+    return table;
+}
+
+LabelTable pass1Parallel (SourceFile * source, TokenStream * stream, int nbrThreads)
+  /* Returns a copy of the label table that was constructed from the lines of source, using nbrThreads threads;
+   *  if stream is not NULL, the tokens of each instruction are added to it.
+   */
+{
+    LabelTable table;              /* The table of labels and addresses. */
+    Pass1Work  work;
+    Pass1Chunk * chunk;
+    pthread_t * threads;
+    int        nbrStarted;         /* Number of threads actually started. */
+    int        lineNum;            /* Line number of the current chunk's first line. */
+    const char * begin, * end;
+    const char * inputEnd;
+    int        i, j;
+
+    if ( nbrThreads <= 1 || ! sourceIsMapped (source) || source->size - source->offset < MIN_PARALLEL_SIZE )
+        return pass1Tokenize (source, stream);
+
+    /* Split the rest of the input into chunks of about the same size, each ending just after a newline. */
+    work.nbrChunks = nbrThreads * CHUNKS_PER_THREAD;
+    work.nextChunk = 0;
+    work.chunks = malloc (work.nbrChunks * sizeof(Pass1Chunk));
+    threads = malloc (nbrThreads * sizeof(pthread_t));
+    if ( work.chunks == NULL || threads == NULL )
+    {
+        free (work.chunks);
+        free (threads);
+        return pass1Tokenize (source, stream);  /* Do without the threads. */
+    }
+    begin = source->data + source->offset;
+    inputEnd = source->data + source->size;
+    for ( i = 0; i < work.nbrChunks; i++ )
+    {
+        end = i == work.nbrChunks - 1 ? inputEnd
+                                      : begin + (inputEnd - begin) / (work.nbrChunks - i);
+        if ( end < inputEnd && (end = memchr (end, '\n', inputEnd - end)) == NULL )
+            end = inputEnd;
+        else if ( end < inputEnd )
+            end++;
+
+        chunk = &work.chunks[i];
+        chunk->begin = begin;
+        chunk->end = end;
+        chunk->nbrLines = 0;
+        chunk->nbrLabels = 0;
+        chunk->labelsCapacity = 0;
+        chunk->labels = NULL;
+        streamInit (&chunk->stream);
+        chunk->failed = 0;
+        begin = end;
+    }
+    source->offset = source->size;      /* The whole input has been read. */
+
+    /* The character scanners choose their version the first time one is called (see CharScan.h);
+     *  have that happen here, before the threads share them.
+     */
+    (void) scanComment (inputEnd, inputEnd);
+    (void) pthread_mutex_init (&work.lock, NULL);
+
+    /* Start the pool, and work in this thread too.  If a thread cannot be
+     *  started, the ones that were (or just this one) take its share.
+     */
+    for ( nbrStarted = 0; nbrStarted < nbrThreads - 1; nbrStarted++ )
+        if ( pthread_create (&threads[nbrStarted], NULL, pass1Worker, &work) != 0 )
+            break;
+    (void) pass1Worker (&work);
+    for ( i = 0; i < nbrStarted; i++ )
+        (void) pthread_join (threads[i], NULL);
+    logFlush ();                    /* Write out the threads' messages. */
+
+    /* Create a label table that holds all of the chunks' labels to begin with. */
+    for ( i = 0, j = 0; i < work.nbrChunks; i++ )
+        j += work.chunks[i].nbrLabels;
+    tableInit (&table);
+    if ( tableResize (&table, j < MIN_LABEL_ESTIMATE ? MIN_LABEL_ESTIMATE : j) == 0 )
+        work.nbrChunks = 0;         /* Error message already printed; nothing can be added. */
+
+    /* Each chunk starts where the chunks before it left off (a prefix sum of their line counts).
+     *  Add the chunks' labels and instructions in order, so everything is as pass1Tokenize
+     *  would have found it; stop after a chunk that ran out of memory, as pass1Tokenize would.
+     */
+    for ( i = 0, lineNum = 1; i < work.nbrChunks; lineNum += work.chunks[i].nbrLines, i++ )
+    {
+        chunk = &work.chunks[i];
+        for ( j = 0; j < chunk->nbrLabels; j++ )
+            if ( addLabelN (&table, chunk->labels[j].begin, chunk->labels[j].length,
+                            chunk->labels[j].PC + 4 * (lineNum - 1)) == 0 )
             {
                 /* Error message already printed.  An error message is printed to the standard error by addLabel. */
-                continue;
             }
-        }
+        if ( stream != NULL && streamAppend (stream, &chunk->stream, lineNum - 1, 4 * (lineNum - 1)) == 0 )
+            break;                  /* FATAL ERROR: Couldn't allocate memory. */
+        if ( chunk->failed )
+            break;
     }
 
-    /* EOF, but don't close the file here. */
+    for ( i = 0; i < nbrThreads * CHUNKS_PER_THREAD; i++ )
+    {
+        free (work.chunks[i].labels);
+        streamDestroy (&work.chunks[i].stream);
+    }
+    (void) pthread_mutex_destroy (&work.lock);
+    free (work.chunks);
+    free (threads);
+
+    /* The table is read-only from here on, so give it a single-probe layout for pass2. */
+    (void) tableFreeze (&table);
+
     return table;
 }
+
+int pass1Line (const LineView * line, int lineNum, int PC, LineView * label,
+               TokenStream * stream)
+  /* Postcondition: label describes the line's label, or has a NULL beginning if the line has none;
+   *                  if stream is not NULL and the line has an instruction, its tokens have been added to stream.
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+    int    hasLabel;               /* Whether the line has a label. */
+    const char * end;              /* End of the line, or of the part before a comment. */
+    const char * tokBegin, * tokEnd;   /* Used to step through instruction. */
+
+    label->begin = NULL;
+    STAT_SAMPLE_START (TIMER_TOKENIZE);
+
+    /* If the line starts with a comment, move on to next line.
+     * If there's a comment later in the line, the line ends where the comment begins.
+     */
+    if ( line->length > 0 && *line->begin == '#' )
+    {
+        STAT_SAMPLE_STOP (TIMER_TOKENIZE);
+        return 1;
+    }
+    end = scanComment (line->begin, line->begin + line->length);
+
+    /* Read the first token, skipping any leading whitespace. */
+    tokBegin = line->begin;
+    getTokenN (&tokBegin, &tokEnd, end);
+        /* tokBegin now points to 1st non-whitespace character in the token;
+         * tokEnd points to 1st punctuation mark or whitespace after the end of the token
+         *  (or to the end of the line).
+         */
+
+    /* Check the line to see if it has a label; if it does, hand it back and move on to the token after it. */
+    hasLabel = tokEnd != end && *(tokEnd) == ':';
+    if ( hasLabel )
+    {
+        label->begin = tokBegin;
+        label->length = tokEnd - tokBegin;
+
+        tokBegin = tokEnd + 1;
+        getTokenN (&tokBegin, &tokEnd, end);
+    }
+
+    /* Record the instruction's tokens, if there is an instruction, for pass2Tokens. */
+    if ( stream != NULL && tokBegin != end &&
+         streamAddLine (stream, lineNum, PC, hasLabel, tokBegin, end) == 0 )
+    {
+        STAT_SAMPLE_STOP (TIMER_TOKENIZE);
+        return 0;                   /* FATAL ERROR: Couldn't allocate memory. */
+    }
+
+    STAT_SAMPLE_STOP (TIMER_TOKENIZE);
+    return 1;
+}
+
+int pass1EstimateLabels (const SourceFile * source)
+  /* Returns the number of labels a table for source should be able to hold to begin with. */
+{
+    const char * next, * end;      /* Used to step through the colons of a mapping. */
+    struct stat  info;             /* Status of a file read through stdio. */
+    long         estimate = 0;
+
+    if ( sourceIsMapped (source) )
+    {
+        /* Every label ends in a colon; count them all. */
+        end = source->data + source->size;
+        for ( next = source->data + source->offset;
+              estimate < MAX_LABEL_ESTIMATE && (next = memchr (next, ':', end - next)) != NULL;
+              next++ )
+            estimate++;
+    }
+    else if ( fstat (fileno (source->fp), &info) == 0 && S_ISREG (info.st_mode) )
+    {
+        /* The file cannot be read twice, so go by its size. */
+        estimate = info.st_size / BYTES_PER_LABEL;
+        if ( estimate > MAX_LABEL_ESTIMATE )
+            estimate = MAX_LABEL_ESTIMATE;
+    }
+
+    return estimate < MIN_LABEL_ESTIMATE ? MIN_LABEL_ESTIMATE : (int) estimate;
+}
+
+static void * pass1Worker (void * arg)
+  /* Scans chunks of the input, one after another, until there are no more (see pass1Parallel). */
+{
+    Pass1Work * work = arg;
+    int    chunk;
+
+    logThreadStart ();              /* Buffer this thread's messages until it is done. */
+    for ( ;; )
+    {
+        (void) pthread_mutex_lock (&work->lock);
+        chunk = work->nextChunk++;
+        (void) pthread_mutex_unlock (&work->lock);
+        if ( chunk >= work->nbrChunks )
+            break;
+        scanChunk (&work->chunks[chunk]);
+    }
+
+    logThreadEnd ();
+    statsThreadEnd ();              /* Add this thread's counts to the totals. */
+    return NULL;
+}
+
+static void scanChunk (Pass1Chunk * chunk)
+  /* Postcondition: chunk holds the number of lines between its beginning and end, and the labels
+   *                  and instructions on them, numbered and addressed from the start of the chunk.
+   */
+{
+    LineView line;                 /* The current line (not null-terminated). */
+    LineView label;                /* The line's label, if it has one. */
+    const char * newline;
+    ChunkLabel * newLabels;
+    int    status;                 /* 0 if memory ran out on the line. */
+
+    for ( line.begin = chunk->begin; line.begin < chunk->end; line.begin += line.length + 1 )
+    {
+        /* The line runs to the next newline (or the end of the chunk), as in sourceNextLine. */
+        newline = memchr (line.begin, '\n', chunk->end - line.begin);
+        line.length = (newline == NULL ? chunk->end : newline) - line.begin;
+        STAT_ADD (STAT_LINES_READ, 1);
+        STAT_ADD (STAT_BYTES_READ, line.length + (newline != NULL));
+
+        status = pass1Line (&line, chunk->nbrLines + 1, 4 * chunk->nbrLines, &label, &chunk->stream);
+        chunk->nbrLines++;
+
+        if ( label.begin != NULL )
+        {
+            if ( chunk->nbrLabels == chunk->labelsCapacity )
+            {
+                if ((newLabels = realloc (chunk->labels,
+                                          (2 * chunk->labelsCapacity + 16) * sizeof(ChunkLabel))) == NULL)
+                {
+                    printError ("Error: cannot allocate space in memory.\n");
+                    chunk->failed = 1;
+                    return;         /* FATAL ERROR: Couldn't allocate memory. */
+                }
+                chunk->labels = newLabels;
+                chunk->labelsCapacity = 2 * chunk->labelsCapacity + 16;
+            }
+            chunk->labels[chunk->nbrLabels].begin = label.begin;
+            chunk->labels[chunk->nbrLabels].length = label.length;
+            chunk->labels[chunk->nbrLabels].PC = 4 * (chunk->nbrLines - 1);
+            chunk->nbrLabels++;
+        }
+
+        if ( status == 0 )
+        {
+            chunk->failed = 1;
+            return;                 /* FATAL ERROR: Couldn't allocate memory. */
+        }
+    }
+}
@@ -1,14 +1,35 @@
 /**
- * LabelTable pass2 (FILE * fp, LabelTable table)
- *      @param  fp  pointer to an open file (stdin or other file pointer)
- *                  from which to read lines of assembly source code
- *      @param  table  an existing Label Table
- *      @return a newly-created table containing labels found in the
- *              input file, each with the address of the instruction
- *              containing it (assuming the first line of input
- *              corresponds to address 0)
+ * void pass2Tokens (const TokenStream * stream, LabelTable table, WordBuffer * words)
+ *      @param  stream  the tokens of every instruction line, as recorded by
+ *                      pass1Tokenize or pass1Parallel (see TokenStream.h)
+ *      @param  table   the label table built from the same input
+ *      @param  words   the buffer to add the encoded instructions to
  *
- * DESCRIPTION MISSING !
+ * Processes each recorded instruction: encodes it, patches in the address
+ * of its label operand (if any) from the label table, and adds the
+ * resulting word to words, so that the words can be written out all at
+ * once in any output format (see WordBuffer.h).  The input is not read or
+ * scanned again.
+ * Label operands are looked up a block of lines at a time, with
+ * findLabelsBatch, so that the lookups' cache misses overlap.
+ * Errors, such as a malformed instruction or an undefined label, are
+ * reported with printError.  A malformed instruction is replaced by a
+ * word of zeros (a nop), and an undefined label is left as zero in its
+ * instruction, so that every word stays at the address pass1 gave it.
+ *
+ * void pass2Parallel (const TokenStream * stream, LabelTable table,
+ *                     WordBuffer * words, int nbrThreads)
+ *      Does the same as pass2Tokens, on nbrThreads threads.  Once pass1 is
+ *      done, each line's word depends only on its own tokens, its PC, and
+ *      the label table, which nothing changes any more; so the recorded
+ *      lines are split into chunks, a pool of threads encodes the chunks
+ *      (taking the next chunk as each one finishes) into a word buffer per
+ *      chunk, and the chunks' words are then added to words in order.
+ *      Errors are reported as each thread finds them, so they may not be
+ *      in line order.
+ *
+ * int encodeTokens (...)
+ *      Encodes the instruction in one recorded line; shared with onePass.
  *
  * Author: <author>
  * Date:   <date>
@@ -18,88 +39,378 @@
  *
  */
 
+#include <pthread.h>
+
 #include "assembler.h"
 
-/* Declaration of stub function defined later in this file. */
-void processInstruction(char * instName, char * restOfInstruction,
-                        int lineNum, int PC);
+/* Number of chunks pass2Parallel splits the lines into, per thread, so that
+ *  a thread that finishes early can take over work from a slower one.
+ */
+#define CHUNKS_PER_THREAD 8
+
+/* Number of lines whose label operands are looked up together (see processLines). */
+#define BATCH_LINES 64
+
+/* Largest number parseNumber accepts: past the range of every field (see FIELDS in
+ *  InstructionSet.c), and small enough for a long of any size.
+ */
+#define MAX_NUMBER 0x7fffffffL
+
+/* The work shared by the threads of pass2Parallel. */
+typedef struct {
+    const TokenStream * stream;
+    LabelTable *    table;
+    int             nbrChunks;
+    int             linesPerChunk;
+    WordBuffer *    chunkWords;     /* Words of each chunk. */
+    int             nextChunk;      /* Next chunk no thread has taken yet. */
+    int             failed;         /* Set if a thread ran out of memory. */
+    pthread_mutex_t lock;           /* Protects nextChunk and failed. */
+} Pass2Work;
+
+/* Define error messages (global within this file). */
+static char * TOO_FEW = "Instruction contains fewer tokens than expected.";
+static char * TOO_MANY = "Instruction contains more tokens than expected.";
+
+/* Declaration of functions defined later in this file. */
+static int processLines (const TokenStream * stream, int first, int last, LabelTable * table,
+                         WordBuffer * words);
+static int processInstruction(const TokenSpan * instName, const TokenSpan arguments[], int nbrArguments,
+                              int lineNum, uint32_t * word, LabelRef * ref);
+static int parseNumber(const TokenSpan * span, long * value);
+static void * pass2Worker (void * work);
+
+void pass2Tokens (const TokenStream * stream, LabelTable table, WordBuffer * words)
+  /* Processes the instructions recorded in stream, adding their words to words. */
+{
+    /* Every line in the stream has an instruction; comments, blank lines, and
+     *  lines containing only a label were left out when it was recorded.
+     */
+    (void) processLines (stream, 0, stream->nbrLines, &table, words);
+}
+
+void pass2Parallel (const TokenStream * stream, LabelTable table, WordBuffer * words, int nbrThreads)
+  /* Processes the instructions recorded in stream on nbrThreads threads, adding their words to words in order. */
+{
+    Pass2Work  work;
+    pthread_t * threads;
+    int        nbrStarted;         /* Number of threads actually started. */
+    int        i;
+
+    if ( nbrThreads <= 1 || stream->nbrLines < 2 * nbrThreads )
+    {
+        /* Not worth the threads. */
+        pass2Tokens (stream, table, words);
+        return;
+    }
+
+    work.stream = stream;
+    work.table = &table;
+    work.nbrChunks = nbrThreads * CHUNKS_PER_THREAD;
+    work.linesPerChunk = (stream->nbrLines + work.nbrChunks - 1) / work.nbrChunks;
+    work.nbrChunks = (stream->nbrLines + work.linesPerChunk - 1) / work.linesPerChunk;
+    work.nextChunk = 0;
+    work.failed = 0;
+    work.chunkWords = malloc (work.nbrChunks * sizeof(WordBuffer));
+    threads = malloc (nbrThreads * sizeof(pthread_t));
+    if ( work.chunkWords == NULL || threads == NULL )
+    {
+        free (work.chunkWords);
+        free (threads);
+        pass2Tokens (stream, table, words);     /* Do without the threads. */
+        return;
+    }
+    for ( i = 0; i < work.nbrChunks; i++ )
+        wordsInit (&work.chunkWords[i]);
+    (void) pthread_mutex_init (&work.lock, NULL);
+
+    /* Start the pool, and work in this thread too.  If a thread cannot be
+     *  started, the ones that were (or just this one) take its share.
+     */
+    for ( nbrStarted = 0; nbrStarted < nbrThreads - 1; nbrStarted++ )
+        if ( pthread_create (&threads[nbrStarted], NULL, pass2Worker, &work) != 0 )
+            break;
+    (void) pass2Worker (&work);
+    for ( i = 0; i < nbrStarted; i++ )
+        (void) pthread_join (threads[i], NULL);
+    logFlush ();                    /* Write out the threads' messages. */
+
+    /* Put the chunks' words together, in order. */
+    for ( i = 0; i < work.nbrChunks; i++ )
+    {
+        if ( ! work.failed && wordsAppendAll (words, &work.chunkWords[i]) == 0 )
+            work.failed = 1;
+        wordsDestroy (&work.chunkWords[i]);
+    }
+
+    (void) pthread_mutex_destroy (&work.lock);
+    free (work.chunkWords);
+    free (threads);
+}
+
+static void * pass2Worker (void * arg)
+  /* Encodes chunks of lines, one after another, until there are no more (see pass2Parallel). */
+{
+    Pass2Work * work = arg;
+    int    chunk;
+    int    first, last;
+
+    logThreadStart ();              /* Buffer this thread's messages until it is done. */
+    for ( ;; )
+    {
+        (void) pthread_mutex_lock (&work->lock);
+        chunk = work->failed ? work->nbrChunks : work->nextChunk++;
+        (void) pthread_mutex_unlock (&work->lock);
+        if ( chunk >= work->nbrChunks )
+            break;
+
+        first = chunk * work->linesPerChunk;
+        last = first + work->linesPerChunk;
+        if ( last > work->stream->nbrLines )
+            last = work->stream->nbrLines;
+        if ( processLines (work->stream, first, last, work->table, &work->chunkWords[chunk]) == 0 )
+        {
+            /* FATAL ERROR: Couldn't allocate memory.  Stop taking chunks. */
+            (void) pthread_mutex_lock (&work->lock);
+            work->failed = 1;
+            (void) pthread_mutex_unlock (&work->lock);
+        }
+    }
+
+    logThreadEnd ();
+    statsThreadEnd ();
+    return NULL;
+}
 
-void pass2 (FILE * fp, LabelTable table)
-  /* Returns a copy of the label table that was constructed */
+static int processLines (const TokenStream * stream, int first, int last, LabelTable * table,
+                         WordBuffer * words)
+  /* Postcondition: The instructions on lines first to last - 1 of stream have been encoded,
+   *                  with their label operands (if any) patched in, and added to words;
+   *                  or their errors have been reported.
+   * Returns 1 if everything went OK (including reported errors in the instructions);
+   *         0 if memory allocation error
+   */
 {
-    int    lineNum;                /* Line number. */
-    int    PC;                     /* Program counter (PC). */
-    char * tokBegin, * tokEnd;     /* Used to step through instruction. */
-    char   inst[BUFSIZ];           /* Will hold instruction; BUFSIZ is max size of I/O buffer (defined in stdio.h). */
-    char * instrName;              /* Instruction name (e.g., "add"). */
-
-    /* Continuously read next line of input until EOF is encountered.*/
-    for (lineNum = 1, PC = 0; fgets (inst, BUFSIZ, fp); lineNum++, PC += 4)
+    const char * begins[BATCH_LINES];  /* Label operands of a block of lines. */
+    size_t lengths[BATCH_LINES];
+    int    addresses[BATCH_LINES];     /* Address of each label operand, or -1 if it is not defined. */
+    int    operand[BATCH_LINES];       /* Number of each line's label operand in begins, or -1 if none. */
+    int    nbrOperands;
+    const TokenLine * line;
+    TokenSpan span;
+    uint32_t word;                 /* Encoded instruction. */
+    LabelRef ref;                  /* Label operand of the instruction, if any. */
+    int    address;                /* Address of the label operand. */
+    int    block, blockSize, i, t;
+
+    for ( block = first; block < last; block += blockSize )
     {
-        /* If the line starts with a comment, move on to next line.
-         * If there's a comment later in the line, strip it off (replace the '#' with a null byte).
+        blockSize = last - block < BATCH_LINES ? last - block : BATCH_LINES;
+
+        /* Every label is in the table by now, so the label operands of the whole block can be
+         *  looked up at once.  A line's label operand is its first operand that is a name:
+         *  a name in any other operand is an error, which encodeTokens reports.
          */
-        if ( *inst == '#' ) continue;
-        (void) strtok (inst, "#");
-
-        /* Read the first token, skipping any leading whitespace. */
-        tokBegin = inst;
-        getToken (&tokBegin, &tokEnd);
-            /* tokBegin now points to 1st non-whitespace character in the token;
-			 * tokEnd points to 1st punctuation mark or whitespace after the end of the token.
-             */
-
-        /* Skip label, if any. */
-        if ( *(tokEnd) == ':' )
+        nbrOperands = 0;
+        for ( i = 0; i < blockSize; i++ )
+        {
+            line = &stream->lines[block + i];
+            operand[i] = -1;
+            for ( t = line->firstToken + 1; t < line->firstToken + line->nbrTokens; t++ )
+                if ( stream->tokens[t].kind == TOKEN_LABEL )
+                {
+                    span = streamSpan (stream, t);
+                    begins[nbrOperands] = span.begin;
+                    lengths[nbrOperands] = span.length;
+                    operand[i] = nbrOperands++;
+                    break;
+                }
+        }
+        (void) findLabelsBatch (table, begins, lengths, nbrOperands, addresses);
+
+        /* Encode the lines in order, patching in their label operands. */
+        for ( i = 0; i < blockSize; i++ )
         {
-            /* Line has a label.  Adjust beginning pointer of new token. */
-            tokBegin = tokEnd + 1;
-			/* Get new token. */
-            getToken (&tokBegin, &tokEnd);
+            line = &stream->lines[block + i];
+
+            /* Encode the instruction.  If it has errors (already reported), it is a nop instead. */
+            (void) encodeTokens (stream, line, &word, &ref);
+
+            if ( ref.use != LABEL_NONE )
+            {
+                address = operand[i] != -1 && ref.begin == begins[operand[i]]
+                          ? addresses[operand[i]] : findLabelN (table, ref.begin, ref.length);
+                if ( address == -1 )
+                    printError ("Error on line %d: label %.*s is not defined.\n",
+                                line->lineNum, (int) ref.length, ref.begin);
+                else if ( patchLabel (&word, ref.use, address, line->PC) == 0 )
+                    printError ("Error on line %d: branch target %.*s is out of range.\n",
+                                line->lineNum, (int) ref.length, ref.begin);
+            }
+
+            if ( wordsAppend (words, word) == 0 )
+                return 0;           /* FATAL ERROR: Couldn't allocate memory. */
         }
+    }
+
+    return 1;
+}
+
+int encodeTokens (const TokenStream * stream, const TokenLine * line,
+                  uint32_t * word, LabelRef * ref)
+  /* Precondition: line is one of the line records in stream.
+   * Postcondition: *word is the encoded instruction, with its label field (if any) left as zero;
+   *                ref describes the instruction's label operand (ref->use is LABEL_NONE if none),
+   *                  and points into the stream's text, which is not changed.
+   * Returns 1 if the instruction was encoded;
+   *         0 if it had errors, which have been reported; *word is then 0 (a nop, to take the
+   *           instruction's place) and ref->use is LABEL_NONE
+   */
+{
+    TokenSpan instrName;           /* Instruction name (e.g., "add"). */
+    TokenSpan arguments[MAX_OPERANDS];  /* Registers or values after name. */
+    int    nbrArguments;           /* Number of arguments on the line. */
+    int    i;
+
+    /* The stream already knows where each token begins and ends, and what kind
+     *  it is, so the tokens are used in place.  Only the first few arguments are
+     *  kept; any beyond that are only counted, to be reported.
+     */
+    instrName = streamSpan (stream, line->firstToken);
+    nbrArguments = line->nbrTokens - 1;
+    for ( i = 0; i < nbrArguments && i < MAX_OPERANDS; i++ )
+        arguments[i] = streamSpan (stream, line->firstToken + 1 + i);
+
+	/* Debug printing of the instruction name. */
+    printDebug ("first non-label token is: %.*s\n", (int) instrName.length, instrName.begin);
+
+    if ( ! processInstruction(&instrName, arguments, nbrArguments, line->lineNum, word, ref) )
+    {
+        *word = 0;
+        ref->use = LABEL_NONE;
+        return 0;
+    }
+    return 1;
+}
 
-        /* If empty line or line containing only a label, get next line. */
-        if ( *tokBegin == '\0' )
-            continue;
+/*
+ * processInstruction encodes an instruction from its name and operands.
+ * The instruction's entry in the instruction set (see InstructionSet.h)
+ * gives its opcode and function code and its format; the format says
+ * which field each operand fills, and the field says where its bits go
+ * and what kind of token should fill it.  A label operand is left as
+ * zero and described in ref, to be patched in once its address is known.
+ */
+static int processInstruction(const TokenSpan * instName, const TokenSpan arguments[], int nbrArguments,
+                              int lineNum, uint32_t * word, LabelRef * ref)
+{
+    const Mnemonic * mnemonic;     /* The instruction's opcode, function code, and format. */
+    const Format *   format;       /* Which field each operand fills. */
+    const Field *    field;        /* The field the current operand fills. */
+    long   value;                  /* Value of the current operand. */
+    int    i;
 
-        /* We have a valid token.  Set the token end pointer to the null byte. */
-        *tokEnd = '\0';
-		/* Store the token as a string. */
-        instrName = tokBegin;
-		/* Set tokBegin to point to the character after the end. */
-        tokBegin = tokEnd + 1;
+    mnemonic = lookupMnemonic(instName->begin, instName->length);
+    if ( mnemonic == NULL )
+    {
+        printError("Error on line %d: %.*s is not a valid instruction.\n",
+                   lineNum, (int) instName->length, instName->begin);
+        return 0;
+    }
+    format = &FORMATS[mnemonic->format];
 
-		/* Debug printing of the instruction name. */
-        printDebug ("first non-label token is: %s\n", instrName);
+    /* Check the number of operands. */
+    if ( nbrArguments != format->nbrOperands )
+    {
+        printError("Error on line %d: %s\n", lineNum,
+                   nbrArguments < format->nbrOperands ? TOO_FEW : TOO_MANY);
+        return 0;
+    }
 
-        /* CALL STUB CODE TO PROCESS INSTRUCTION !!! */
-        processInstruction(instrName, tokBegin, lineNum, PC);
+    /* Print the instruction name and its operands. */
+    printDebug("Line %d: %.*s", lineNum, (int) instName->length, instName->begin);
+    for ( i = 0; i < nbrArguments; i++ )
+        printDebug("%s%.*s", i == 0 ? " " : ", ", (int) arguments[i].length, arguments[i].begin);
+    printDebug("\n");
 
+    /* Put each operand's value into its field. */
+    *word = mnemonic->opcode << 26 | mnemonic->funct;
+    ref->use = LABEL_NONE;
+    for ( i = 0; i < nbrArguments; i++ )
+    {
+        field = &FIELDS[format->operands[i]];
+        if ( arguments[i].kind != field->tokenKind )
+        {
+            printError("Error on line %d: %.*s is not a valid %s.\n", lineNum,
+                       (int) arguments[i].length, arguments[i].begin, field->what);
+            return 0;
+        }
+
+        switch ( field->tokenKind )
+        {
+            case TOKEN_REGISTER:
+                value = lookupRegister(arguments[i].begin, arguments[i].length);
+                break;
+            case TOKEN_LABEL:
+                ref->begin = arguments[i].begin;
+                ref->length = arguments[i].length;
+                ref->use = format->operands[i] == FIELD_TARGET ? LABEL_JUMP : LABEL_BRANCH;
+                value = 0;              /* Patched in once the label is found (see patchLabel). */
+                break;
+            default:
+                if ( ! parseNumber(&arguments[i], &value) )
+                    value = field->max + 1;     /* Not a number: report it as out of range. */
+                break;
+        }
+        if ( value < field->min || value > field->max )
+        {
+            printError("Error on line %d: %.*s is not a valid %s.\n", lineNum,
+                       (int) arguments[i].length, arguments[i].begin, field->what);
+            return 0;
+        }
+
+        *word |= ((uint32_t) value & field->mask) << field->shift;
     }
 
-    return;
+    return 1;
 }
 
-/* STUB CODE !!!
-* For now, assume we don't care what type of instruction it is,
-* instead just assume all instructions have 3 arguments.
-*/
-void processInstruction(char * instName, char * restOfInstruction,
-                        int lineNum, int PC)
+static int parseNumber(const TokenSpan * span, long * value)
+  /* Postcondition: If span is a decimal number, or a hexadecimal number beginning with 0x,
+   *                  optionally preceded by a sign, and its magnitude is at most MAX_NUMBER,
+   *                  *value is its value and 1 is returned; otherwise, 0 is returned.
+   */
 {
-    char * arguments[3];           /* Registers or values after name. */
+    const char * p = span->begin;
+    const char * end = span->begin + span->length;
+    int    negative = 0;
+    int    base = 10;
+    int    digit;
+    unsigned long long magnitude;   /* Wide enough for MAX_NUMBER * 16 + 15. */
 
-    /* Get the 3 arguments.  (Bad assumption, but this is just a stub.) */
-    if ( ! getNTokens(restOfInstruction, 3, arguments) )
+    if ( p < end && (*p == '-' || *p == '+') )
+        negative = *p++ == '-';
+    if ( end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X') )
     {
-        /* When getNTokens encounters an error, it puts a pointer to the error message in arguments[0]. */
-        printError("Error on line %d: %s\n", lineNum, arguments[0]);
-        return;
+        base = 16;
+        p += 2;
     }
+    if ( p == end )
+        return 0;                   /* No digits. */
 
-    /* Print the instruction name and the 3 arguments. */
-    printDebug("Line %d: %s %s, %s, %s\n", lineNum, instName,
-                        arguments[0], arguments[1], arguments[2]);
+    for ( magnitude = 0; p < end; p++ )
+    {
+        if ( *p >= '0' && *p <= '9' )
+            digit = *p - '0';
+        else if ( base == 16 && tolower((unsigned char) *p) >= 'a' && tolower((unsigned char) *p) <= 'f' )
+            digit = tolower((unsigned char) *p) - 'a' + 10;
+        else
+            return 0;
+        magnitude = magnitude * base + digit;
+        if ( magnitude > MAX_NUMBER )
+            return 0;               /* Too big for any field; stop before it can overflow. */
+    }
 
-    return;
+    *value = negative ? -(long) magnitude : (long) magnitude;
+    return 1;
 }
@@ -0,0 +1,392 @@
+/**
+ * LabelTable pipelinePass (FILE * fp, WordBuffer * words)
+ *      @param  fp      pointer to an open file (stdin or other file pointer)
+ *                      from which to read assembly source code
+ *      @param  words   an empty word buffer to hold the encoded instructions
+ *      @return a newly-created table containing labels found in the
+ *              input, each with the address of the instruction
+ *              containing it (assuming the first line of input
+ *              corresponds to address 0)
+ *
+ * This function does the same work as onePass, in three stages that run
+ * at the same time on different threads, so that waiting for input (from
+ * a pipe or a slow disk) overlaps with tokenizing and encoding:
+ *      reader    -- reads the input in large blocks with fread, each block
+ *                   ending at the end of a line (the rest of a line that
+ *                   does not fit is carried over to the next block);
+ *      tokenizer -- splits each block into lines, finds their labels, and
+ *                   records their instructions' tokens (see pass1Line in
+ *                   pass1.c), giving a batch of labels and token records
+ *                   numbered and addressed from the start of the input;
+ *      encoder   -- adds each batch's labels to the table and encodes its
+ *                   instructions, in line order, as onePass does (see
+ *                   onePassLabel and onePassLine in onePass.c).
+ * The reader and tokenizer have threads of their own; the encoder runs
+ * in the calling thread, so the table and words are only touched there.
+ * Blocks go from the reader to the tokenizer, and batches from the
+ * tokenizer to the encoder, through bounded lock-free rings (see
+ * SpscRing.h), so a fast stage waits for a slow one instead of filling
+ * memory.  If the tokenizer's thread cannot be started, the encoder
+ * tokenizes the blocks itself; if the reader's cannot, onePass is used.
+ *
+ * Unlike the stdio source (see SourceFile.h), a line is never split
+ * because it is long; lines are handled as in a mapped source.
+ *
+ */
+
+#include <pthread.h>
+
+#include "assembler.h"
+#include "SpscRing.h"
+
+/* Size of a block of input. */
+#define BLOCK_SIZE 262144
+
+/* Number of blocks, or batches, that may wait between two stages. */
+#define RING_CAPACITY 8
+
+/* Internal global variables (global to this file only). */
+static const char * ERROR = "Error: cannot allocate space in memory.\n";
+
+/* A block of input, ending at the end of a line (or of the input). */
+typedef struct {
+    char *      text;
+    size_t      length;
+} Block;
+
+/* A label found by the tokenizer, with its line number and address. */
+typedef struct {
+    const char * begin;            /* Points into the batch's block. */
+    size_t      length;
+    int         lineNum;
+    int         PC;
+} BatchLabel;
+
+/* What the tokenizer found in a block. */
+typedef struct {
+    Block *     block;             /* Kept until the encoder is done, for the labels. */
+    int         nbrLabels;
+    int         labelsCapacity;
+    BatchLabel * labels;           /* The block's labels, in order. */
+    TokenStream stream;            /* The block's instructions, in order. */
+    int         failed;            /* Set if memory ran out; the batch stops at that line. */
+} Batch;
+
+/* The stages' shared state. */
+typedef struct {
+    FILE *      fp;
+    SpscRing    blocks;            /* Reader to tokenizer. */
+    SpscRing    batches;           /* Tokenizer to encoder. */
+    int         lineNum;           /* Number of the next line the tokenizer sees. */
+    int         PC;                /* Its address. */
+} Pipeline;
+
+/* Internal functions (visible to this file only). */
+static void * readerStage (void * pipeline);
+static void * tokenizerStage (void * pipeline);
+static Batch * tokenizeBlock (Pipeline * pipeline, Block * block);
+static void freeBlock (Block * block);
+static void freeBatch (Batch * batch);
+
+LabelTable pipelinePass (FILE * fp, WordBuffer * words)
+  /* Returns a copy of the label table that was constructed. */
+{
+    LabelTable table;              /* The table of labels and addresses. */
+    FixupList fixups;              /* References to labels not defined yet. */
+    Pipeline   pipeline;
+    pthread_t  reader, tokenizer;
+    int        haveTokenizer;      /* Whether the tokenizer has a thread of its own. */
+    Batch *    batch;
+    Block *    block;
+    int        failed = 0;         /* Set once memory has run out; the rest is just drained. */
+    int        i, j;
+    SourceFile source;
+
+    pipeline.fp = fp;
+    pipeline.lineNum = 1;
+    pipeline.PC = 0;
+    if ( ! ringInit (&pipeline.blocks, RING_CAPACITY) )
+    {
+        tableInit (&table);
+        return table;
+    }
+    if ( ! ringInit (&pipeline.batches, RING_CAPACITY) )
+    {
+        ringDestroy (&pipeline.blocks);
+        tableInit (&table);
+        return table;
+    }
+
+    /* The character scanners choose their version the first time one is called (see CharScan.h);
+     *  have that happen here, before another thread uses them.
+     */
+    (void) scanComment (ERROR, ERROR);
+
+    if ( pthread_create (&reader, NULL, readerStage, &pipeline) != 0 )
+    {
+        /* Do without the stages. */
+        ringDestroy (&pipeline.blocks);
+        ringDestroy (&pipeline.batches);
+        sourceOpen (&source, fp, 0);
+        table = onePass (&source, words);
+        sourceClose (&source);
+        return table;
+    }
+    haveTokenizer = pthread_create (&tokenizer, NULL, tokenizerStage, &pipeline) == 0;
+
+    /* Create a label table about the size the input needs to begin with
+     *  (judged from the size of the file, since the reader is already reading it; see pass1.c).
+     */
+    sourceOpen (&source, fp, 0);
+    tableInit (&table);
+    fixupInit (&fixups);
+    if ( tableResize (&table, pass1EstimateLabels (&source)) == 0 )
+        failed = 1;                 /* Error message already printed by tableResize. */
+
+    /* Encode each batch as it comes, putting its labels and instructions in line order,
+     *  as onePass would have met them.
+     */
+    for ( ;; )
+    {
+        if ( haveTokenizer )
+            batch = ringPop (&pipeline.batches);
+        else
+            batch = (block = ringPop (&pipeline.blocks)) == NULL ? NULL : tokenizeBlock (&pipeline, block);
+        if ( batch == NULL )
+            break;                  /* End of the input (or FATAL ERROR: Couldn't allocate memory). */
+
+        for ( i = 0, j = 0; ! failed && (i < batch->nbrLabels || j < batch->stream.nbrLines); )
+        {
+            if ( j == batch->stream.nbrLines ||
+                 (i < batch->nbrLabels && batch->labels[i].lineNum <= batch->stream.lines[j].lineNum) )
+            {
+                (void) onePassLabel (&table, &fixups, batch->labels[i].begin, batch->labels[i].length,
+                                     batch->labels[i].PC, words);
+                i++;
+            }
+            else if ( onePassLine (&batch->stream, &batch->stream.lines[j++], &table, &fixups, words) == 0 )
+                failed = 1;         /* FATAL ERROR: Couldn't allocate memory. */
+        }
+        if ( batch->failed )
+            failed = 1;             /* FATAL ERROR: Couldn't allocate memory. */
+        freeBatch (batch);
+    }
+
+    /* Without a tokenizer, the encoder takes the blocks; let the reader finish if it stopped early. */
+    if ( ! haveTokenizer )
+        while ( (block = ringPop (&pipeline.blocks)) != NULL )
+            freeBlock (block);
+
+    (void) pthread_join (reader, NULL);
+    if ( haveTokenizer )
+        (void) pthread_join (tokenizer, NULL);
+    logFlush ();                    /* Write out the other stages' messages. */
+    ringDestroy (&pipeline.blocks);
+    ringDestroy (&pipeline.batches);
+
+    /* Any label still awaited was never defined. */
+    (void) fixupReportUnresolved (&fixups);
+    fixupDestroy (&fixups);
+
+    /* EOF, but don't close the file here. */
+    return table;
+}
+
+static void * readerStage (void * arg)
+  /* Reads the input into blocks that end at the end of a line, and passes them on. */
+{
+    Pipeline * pipeline = arg;
+    Block *    block;
+    Block *    next;
+    size_t     capacity;           /* Room in the current block's text. */
+    size_t     nextCapacity = 0;   /* Room in the next block's text. */
+    size_t     rest;               /* Length of the part of a line carried over to the next block. */
+    size_t     nbrRead;
+    char *     newText;
+    const char * lastNewline;
+    int        atEnd = 0;
+
+    logThreadStart ();              /* Buffer this thread's messages until it is done. */
+    if ( (block = malloc (sizeof(Block))) == NULL ||
+         (block->text = malloc (BLOCK_SIZE)) == NULL )
+    {
+        printError ("%s", ERROR);
+        free (block);
+        ringClose (&pipeline->blocks);
+        logThreadEnd ();
+        statsThreadEnd ();
+        return NULL;                /* FATAL ERROR: Couldn't allocate memory. */
+    }
+    block->length = 0;
+    capacity = BLOCK_SIZE;
+
+    while ( ! atEnd )
+    {
+        /* Fill the block; a short read means the end of the input (or an error). */
+        STAT_TIMER_START (TIMER_READ);
+        nbrRead = fread (block->text + block->length, 1, capacity - block->length, pipeline->fp);
+        STAT_TIMER_STOP (TIMER_READ);
+        STAT_ADD (STAT_BYTES_READ, nbrRead);
+        block->length += nbrRead;
+        atEnd = block->length < capacity;
+
+        /* The block ends after its last newline; if it has none, the line is longer than the block, so grow it. */
+        for ( lastNewline = block->text + block->length - 1;
+              lastNewline >= block->text && *lastNewline != '\n'; lastNewline-- )
+            ;
+        if ( lastNewline < block->text )
+            lastNewline = NULL;
+        if ( ! atEnd && lastNewline == NULL )
+        {
+            if ( (newText = realloc (block->text, 2 * capacity)) == NULL )
+            {
+                printError ("%s", ERROR);
+                break;              /* FATAL ERROR: Couldn't allocate memory. */
+            }
+            block->text = newText;
+            capacity *= 2;
+            continue;
+        }
+
+        /* Start the next block with the rest of the last line. */
+        next = NULL;
+        if ( ! atEnd )
+        {
+            /* The rest may be more than a block, if this block was grown for a long line. */
+            rest = block->length - (lastNewline + 1 - block->text);
+            nextCapacity = rest < BLOCK_SIZE / 2 ? BLOCK_SIZE : 2 * rest;
+            if ( (next = malloc (sizeof(Block))) == NULL ||
+                 (next->text = malloc (nextCapacity)) == NULL )
+            {
+                printError ("%s", ERROR);
+                free (next);
+                break;              /* FATAL ERROR: Couldn't allocate memory. */
+            }
+            next->length = rest;
+            (void) memcpy (next->text, lastNewline + 1, rest);
+            block->length -= rest;
+        }
+
+        if ( block->length > 0 )
+            ringPush (&pipeline->blocks, block);
+        else
+            freeBlock (block);
+        block = next;
+        capacity = nextCapacity;
+    }
+
+    if ( block != NULL )
+        freeBlock (block);          /* Stopped early. */
+    ringClose (&pipeline->blocks);
+    logThreadEnd ();
+    statsThreadEnd ();
+    return NULL;
+}
+
+static void * tokenizerStage (void * arg)
+  /* Turns each block of input into a batch of labels and token records, and passes it on. */
+{
+    Pipeline * pipeline = arg;
+    Block *    block;
+    Batch *    batch;
+
+    logThreadStart ();              /* Buffer this thread's messages until it is done. */
+    while ( (block = ringPop (&pipeline->blocks)) != NULL )
+    {
+        if ( (batch = tokenizeBlock (pipeline, block)) == NULL )
+            break;                  /* FATAL ERROR: Couldn't allocate memory. */
+        ringPush (&pipeline->batches, batch);
+    }
+
+    /* If it stopped early, let the reader finish. */
+    while ( (block = ringPop (&pipeline->blocks)) != NULL )
+        freeBlock (block);
+    ringClose (&pipeline->batches);
+    logThreadEnd ();
+    statsThreadEnd ();
+    return NULL;
+}
+
+static Batch * tokenizeBlock (Pipeline * pipeline, Block * block)
+  /* Returns a batch holding the labels and instructions of the lines in block;
+   *  NULL (after printing an error and freeing block) if memory allocation error.
+   */
+{
+    Batch *    batch;
+    LineView   line;               /* The current line (not null-terminated). */
+    LineView   label;              /* The line's label, if it has one. */
+    const char * end = block->text + block->length;
+    const char * newline;
+    BatchLabel * newLabels;
+    int        status;             /* 0 if memory ran out on the line. */
+
+    if ( (batch = malloc (sizeof(Batch))) == NULL )
+    {
+        printError ("%s", ERROR);
+        freeBlock (block);
+        return NULL;                /* FATAL ERROR: Couldn't allocate memory. */
+    }
+    batch->block = block;
+    batch->nbrLabels = 0;
+    batch->labelsCapacity = 0;
+    batch->labels = NULL;
+    streamInit (&batch->stream);
+    batch->failed = 0;
+
+    for ( line.begin = block->text; line.begin < end; line.begin += line.length + 1 )
+    {
+        /* The line runs to the next newline (or the end of the block), as in sourceNextLine. */
+        newline = memchr (line.begin, '\n', end - line.begin);
+        line.length = (newline == NULL ? end : newline) - line.begin;
+        STAT_ADD (STAT_LINES_READ, 1);
+
+        status = pass1Line (&line, pipeline->lineNum, pipeline->PC, &label, &batch->stream);
+
+        if ( label.begin != NULL )
+        {
+            if ( batch->nbrLabels == batch->labelsCapacity )
+            {
+                if ((newLabels = realloc (batch->labels,
+                                          (2 * batch->labelsCapacity + 16) * sizeof(BatchLabel))) == NULL)
+                {
+                    printError ("%s", ERROR);
+                    batch->failed = 1;
+                    return batch;   /* FATAL ERROR: Couldn't allocate memory. */
+                }
+                batch->labels = newLabels;
+                batch->labelsCapacity = 2 * batch->labelsCapacity + 16;
+            }
+            batch->labels[batch->nbrLabels].begin = label.begin;
+            batch->labels[batch->nbrLabels].length = label.length;
+            batch->labels[batch->nbrLabels].lineNum = pipeline->lineNum;
+            batch->labels[batch->nbrLabels].PC = pipeline->PC;
+            batch->nbrLabels++;
+        }
+
+        pipeline->lineNum++;
+        pipeline->PC += 4;
+        if ( status == 0 )
+        {
+            batch->failed = 1;
+            return batch;           /* FATAL ERROR: Couldn't allocate memory. */
+        }
+    }
+
+    return batch;
+}
+
+static void freeBlock (Block * block)
+  /* Postcondition: The block has been freed. */
+{
+    free (block->text);
+    free (block);
+}
+
+static void freeBatch (Batch * batch)
+  /* Postcondition: The batch, and the block it came from, have been freed. */
+{
+    freeBlock (batch->block);
+    free (batch->labels);
+    streamDestroy (&batch->stream);
+    free (batch);
+}
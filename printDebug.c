@@ -50,10 +50,15 @@ static const char * ERROR = "Error: cannot allocate space in memory.\n";
  *  in the format.
  *
  * Output:
- *  This function prints its output to standard output (stdout).
+ *  This function prints its output to standard output (stdout), or
+ *  buffers it in a thread that has called logThreadStart (see
+ *  printFuncs.h).
+ *
+ * (The name is in parentheses so that it is still defined in a release
+ *  build, where printFuncs.h makes calls to it a macro that does nothing.)
  *
  */
-void printDebug(const char * restrict_format, ...)
+void (printDebug)(const char * restrict_format, ...)
 {
     if ( ! DEBUG )
         return;
@@ -63,7 +68,8 @@ void printDebug(const char * restrict_format, ...)
      */
     va_list ap;
     va_start(ap, restrict_format);
-    (void) vprintf(restrict_format, ap);
+    if ( ! logMessage(stdout, restrict_format, ap) )
+        (void) vprintf(restrict_format, ap);
     va_end(ap);
 
 }
@@ -121,7 +127,7 @@ void debug_restore(void)
  * Returns 1 if debugging is currently on, 0 if debugging is currently off.
  *
  */
-int debug_is_on(void)
+int (debug_is_on)(void)
 {
     return DEBUG;
 }
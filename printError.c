@@ -1,11 +1,71 @@
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sched.h>
 #include "printFuncs.h"
 
+/* A stream only one thread uses needs no locking (glibc lets us say so). */
+#if defined(__GLIBC__)
+#include <stdio_ext.h>
+#define UNLOCKED_STREAM(fp) ((void) __fsetlocking(fp, FSETLOCKING_BYCALLER))
+#else
+#define UNLOCKED_STREAM(fp) ((void) (fp))
+#endif
+
 /** Define the global ERROR_LIMIT variable. **/
 int ERROR_LIMIT = 20;
 
+/* Number of errors printed so far, counted atomically so that threads can share it. */
+static atomic_int error_count = 0;
+
+/* Buffered logging (see printFuncs.h).
+ *
+ * A thread between logThreadStart and logThreadEnd formats its messages
+ * into memory streams of its own (open_memstream), one for stdout and
+ * one for stderr.  What a stream holds is handed to the flusher as a
+ * chunk once it reaches LOG_CHUNK_SIZE, as soon as it holds an error
+ * message (so that no error is left behind in a thread's buffer), and
+ * at logThreadEnd.  Chunks go through LOG_RING, a bounded lock-free
+ * queue that any number of threads may add to; each slot carries a
+ * sequence number telling whose turn it is to fill or empty it.  Only
+ * one thread at a time drains the queue: whichever calls logFlush (or
+ * finds the queue full) and gets the flushing flag.  It writes each
+ * chunk out with one fwrite.
+ */
+#define LOG_CHUNK_SIZE 16384
+#define LOG_RING_SIZE  256
+
+typedef struct {
+    FILE * stream;              /* stdout or stderr. */
+    size_t length;              /* Number of characters in text. */
+    char * text;
+} LogChunk;
+
+typedef struct {
+    _Atomic size_t turn;        /* Sequence number of the next use of the slot, less the slot number. */
+    LogChunk *     chunk;
+} LogSlot;
+
+static LogSlot LOG_RING[LOG_RING_SIZE];
+static _Atomic size_t logAddPos = 0;    /* Number of chunks handed to the flusher. */
+static _Atomic size_t logTakePos = 0;   /* Number of chunks taken by the flusher. */
+static atomic_flag logFlushing = ATOMIC_FLAG_INIT;
+
+/* This thread's buffering state: a memory stream for stdout ([0]) and one for stderr ([1]). */
+static _Thread_local int logIsBuffered = 0;
+static _Thread_local FILE * logFiles[2];
+static _Thread_local char * logTexts[2];
+static _Thread_local size_t logSizes[2];
+static _Thread_local size_t logLengths[2];
+
+static void logHandOffFile(int which);
+static void logHandOff(LogChunk * chunk);
+static int logAdd(LogChunk * chunk);
+static LogChunk * logTake(void);
+static void logDrain(void);
+
 /**
  * printError(const char * restrict_format, ...)
  *
@@ -20,6 +80,11 @@ int ERROR_LIMIT = 20;
  * continue (and continue to generate error messages) until it stops on
  * its own.
  *
+ * In a thread that has called logThreadStart, the message is buffered
+ * instead (see printFuncs.h); the count of errors is shared by all
+ * threads either way, and messages buffered so far are written out
+ * before the program exits.
+ *
  * Parameters:
  *  The parameters to printError are modeled on those to printf,
  *  consisting of a format and various other arguments as specified
@@ -31,21 +96,225 @@ int ERROR_LIMIT = 20;
  */
 void printError(const char * restrict_format, ...)
 {
-    static int error_count = 0;
+    int count;
+
+    /* Keep track of the error count.  Once it has gone too high, one
+     * thread is on its way out, and later errors are not printed.
+     */
+    count = atomic_fetch_add(&error_count, 1) + 1;
+    if ( ERROR_LIMIT > 0 && count > ERROR_LIMIT + 1 )
+        return;
 
     /* The following code allows us to call fprintf with the variable
      * parameters that were passed to printError.
      */
     va_list ap;
     va_start(ap, restrict_format);
-    (void) vfprintf(stderr, restrict_format, ap);
+    if ( ! logMessage(stderr, restrict_format, ap) )
+        (void) vfprintf(stderr, restrict_format, ap);
     va_end(ap);
 
-    /* Keep track of the error count, and exit if it goes too high. */
-    error_count++;
-    if ( ERROR_LIMIT > 0 && error_count > ERROR_LIMIT )
+    /* Exit if the error count has gone too high. */
+    if ( ERROR_LIMIT > 0 && count > ERROR_LIMIT )
     {
+        logFlush();
         exit(1);
     }
 
 }
+
+/**
+ * int errorCount(void)
+ *
+ * Returns the number of errors printError has been asked to print so
+ * far, by every thread (including any not printed because the program
+ * was on its way out).
+ */
+int errorCount(void)
+{
+    return atomic_load(&error_count);
+}
+
+/**
+ * int logMessage(FILE * stream, const char * format, va_list ap)
+ *
+ * Buffers a message for stream (stdout or stderr) if this thread is
+ * between logThreadStart and logThreadEnd.  Returns 1 if it did; 0 if
+ * the caller should print the message itself.
+ */
+int logMessage(FILE * stream, const char * format, va_list ap)
+{
+    int which = stream == stderr;
+    int length;
+
+    if ( ! logIsBuffered )
+        return 0;
+
+    /* Format the message into this thread's memory stream; nothing else uses it, so don't lock it. */
+    if ( logFiles[which] == NULL )
+    {
+        if ( (logFiles[which] = open_memstream(&logTexts[which], &logSizes[which])) == NULL )
+            return 0;           /* Can't buffer; print it instead. */
+        UNLOCKED_STREAM(logFiles[which]);
+    }
+    if ( (length = vfprintf(logFiles[which], format, ap)) > 0 )
+        logLengths[which] += length;
+
+    /* Errors go to the flusher at once, so none is left behind in a thread's buffer. */
+    if ( which == 1 || logLengths[which] >= LOG_CHUNK_SIZE )
+        logHandOffFile(which);
+    return 1;
+}
+
+/**
+ * void logThreadStart(void)
+ *
+ * Buffers this thread's messages from now until logThreadEnd.
+ */
+void logThreadStart(void)
+{
+    logIsBuffered = 1;
+}
+
+/**
+ * void logThreadEnd(void)
+ *
+ * Hands this thread's buffered messages to the flusher, and goes back to
+ * printing them as they come.
+ */
+void logThreadEnd(void)
+{
+    int i;
+
+    for ( i = 0; i < 2; i++ )
+        if ( logFiles[i] != NULL )
+            logHandOffFile(i);
+    logIsBuffered = 0;
+}
+
+/**
+ * void logFlush(void)
+ *
+ * Writes out every message that has been handed to the flusher, in the
+ * order they were handed to it.
+ */
+void logFlush(void)
+{
+    /* Wait for any other flusher to finish, then drain whatever is left. */
+    while ( atomic_flag_test_and_set(&logFlushing) )
+        (void) sched_yield();
+    logDrain();
+    atomic_flag_clear(&logFlushing);
+}
+
+static void logHandOffFile(int which)
+  /* Gives what this thread has buffered in memory stream number which to the flusher. */
+{
+    LogChunk * chunk;
+    FILE *     stream = which ? stderr : stdout;
+
+    (void) fclose(logFiles[which]);     /* Leaves the text in logTexts[which]. */
+    logFiles[which] = NULL;
+    logLengths[which] = 0;
+
+    if ( (chunk = malloc(sizeof(LogChunk))) == NULL )
+    {
+        (void) fwrite(logTexts[which], 1, logSizes[which], stream);   /* Can't buffer; print it. */
+        free(logTexts[which]);
+        return;
+    }
+    chunk->stream = stream;
+    chunk->length = logSizes[which];
+    chunk->text = logTexts[which];
+    logHandOff(chunk);
+}
+
+static void logHandOff(LogChunk * chunk)
+  /* Gives chunk to the flusher, draining the queue first if it is full. */
+{
+    while ( ! logAdd(chunk) )
+    {
+        /* The queue is full: drain it, unless another thread already is. */
+        if ( ! atomic_flag_test_and_set(&logFlushing) )
+        {
+            logDrain();
+            atomic_flag_clear(&logFlushing);
+        }
+        else
+            (void) sched_yield();
+    }
+}
+
+static int logAdd(LogChunk * chunk)
+  /* Returns 1 if chunk was added to the end of LOG_RING; 0 if it was full. */
+{
+    size_t    pos = atomic_load_explicit(&logAddPos, memory_order_relaxed);
+    size_t    slotNbr;
+    intptr_t  wait;
+
+    for ( ;; )
+    {
+        /* The slot is ready to be filled for the pos'th time when its turn equals pos. */
+        slotNbr = pos % LOG_RING_SIZE;
+        wait = (intptr_t) (atomic_load_explicit(&LOG_RING[slotNbr].turn, memory_order_acquire) + slotNbr - pos);
+        if ( wait == 0 )
+        {
+            if ( atomic_compare_exchange_weak_explicit(&logAddPos, &pos, pos + 1,
+                                                       memory_order_relaxed, memory_order_relaxed) )
+                break;
+        }
+        else if ( wait < 0 )
+            return 0;           /* Full: the slot has not been emptied since its last use. */
+        else
+            pos = atomic_load_explicit(&logAddPos, memory_order_relaxed);
+    }
+
+    LOG_RING[slotNbr].chunk = chunk;
+    atomic_store_explicit(&LOG_RING[slotNbr].turn, pos + 1 - slotNbr, memory_order_release);
+    return 1;
+}
+
+static LogChunk * logTake(void)
+  /* Returns the chunk at the front of LOG_RING, taking it out; NULL if it was empty. */
+{
+    size_t    pos = atomic_load_explicit(&logTakePos, memory_order_relaxed);
+    size_t    slotNbr;
+    intptr_t  wait;
+    LogChunk * chunk;
+
+    for ( ;; )
+    {
+        /* The slot is ready to be emptied for the pos'th time when its turn equals pos + 1. */
+        slotNbr = pos % LOG_RING_SIZE;
+        wait = (intptr_t) (atomic_load_explicit(&LOG_RING[slotNbr].turn, memory_order_acquire) + slotNbr - (pos + 1));
+        if ( wait == 0 )
+        {
+            if ( atomic_compare_exchange_weak_explicit(&logTakePos, &pos, pos + 1,
+                                                       memory_order_relaxed, memory_order_relaxed) )
+                break;
+        }
+        else if ( wait < 0 )
+            return NULL;        /* Empty. */
+        else
+            pos = atomic_load_explicit(&logTakePos, memory_order_relaxed);
+    }
+
+    chunk = LOG_RING[slotNbr].chunk;
+    atomic_store_explicit(&LOG_RING[slotNbr].turn, pos + LOG_RING_SIZE - slotNbr, memory_order_release);
+    return chunk;
+}
+
+static void logDrain(void)
+  /* Precondition: This thread holds the flushing flag.
+   * Postcondition: Every chunk in LOG_RING has been written out and freed.
+   */
+{
+    LogChunk * chunk;
+
+    while ( (chunk = logTake()) != NULL )
+    {
+        (void) fwrite(chunk->text, 1, chunk->length, chunk->stream);
+        free(chunk->text);
+        free(chunk);
+    }
+}
@@ -12,6 +12,10 @@
  *      to change the number of errors that get printed before the
  *      programs stops execution.
  *
+ * errorCount returns the number of errors printError has been asked to
+ *      print so far, by every thread, so that a program can exit with a
+ *      non-zero status if there were any.
+ *
  * printDebug will print a debugging message to stdout, but only if
  *      debugging has been turned on.
  *      printDebug takes a variable number of arguments, the first of
@@ -42,12 +46,45 @@
  * override_debug_changes "freezes" the debugging state in its current
  *      state, whether on or off, nulling the effect of any future calls
  *      to debug_on, debug_off, or debug_restore.
+ *
+ * logThreadStart makes printError and printDebug buffer the calling
+ *      thread's messages instead of printing each one as it comes, so
+ *      that threads working at the same time neither interleave their
+ *      messages nor wait on each other for the stdio locks.  Worker
+ *      threads call it when they start.
+ *
+ * logThreadEnd hands the calling thread's buffered messages over to be
+ *      flushed, and goes back to printing messages as they come.  Worker
+ *      threads call it when they finish.
+ *
+ * logFlush writes out every message that has been handed over, in the
+ *      order they were handed over.  Whoever starts worker threads calls
+ *      it after they finish.  (Error messages are handed over as soon as
+ *      they are buffered, and printError flushes them all before exiting
+ *      on reaching ERROR_LIMIT, so no error is lost.)
+ *
+ * logMessage is used by printError and printDebug: it buffers a message
+ *      for stdout or stderr, returning 1, if the calling thread is
+ *      buffering its messages; otherwise it returns 0.
+ *
+ * In a release build (compiled with -DRELEASE; see the release target in
+ *      the Makefile), printDebug and debug_is_on are macros that compile
+ *      to nothing and to 0: debugging messages are never printed, and
+ *      their arguments are never evaluated.  debug_on, debug_off, and
+ *      debug_restore still keep their stack of debugging states, but it
+ *      has no effect.  The functions themselves are still defined, so
+ *      release and debug object files can be linked together.
  */
 
+#include <stdarg.h>
+#include <stdio.h>
+
 void printError(const char * restrict_format, ...);
 
 extern int ERROR_LIMIT;
 
+int  errorCount(void);
+
 void printDebug(const char * restrict_format, ...);
 
 void debug_on(void);
@@ -56,4 +93,14 @@ void debug_restore(void);
 int  debug_is_on(void);
 void override_debug_changes(void);
 
+#if defined(RELEASE)
+#define printDebug(...)  ((void) 0)
+#define debug_is_on()    0
+#endif
+
+void logThreadStart(void);
+void logThreadEnd(void);
+void logFlush(void);
+int  logMessage(FILE * stream, const char * format, va_list ap);
+
 #endif
@@ -6,9 +6,23 @@
  * encounters a fatal error.
  *
  * Usage:
- *      programName  [filename] [0|1]
+ *      programName  [-m] [-s] [-p] [-f format] [-j N] [--stats[=text|json]] [filename] [0|1]
  * If both a filename and a debugging choice are provided, they may
- * be in either order.
+ * be in either order.  Options (arguments that start with '-') may
+ * appear anywhere; each one sets a field of the global OPTIONS:
+ *      -m      map the input file into memory (see SourceFile.h) instead
+ *              of reading it line by line; ignored when reading stdin.
+ *      -s      assemble in a single pass (see onePass.c).
+ *      -p      assemble in a single pass, with reading, tokenizing, and
+ *              encoding overlapped on separate threads (see pipeline.c).
+ *      -f format
+ *              write the encoded words as bits (the default), hex, le
+ *              (little-endian binary), or be (big-endian binary); see
+ *              WordBuffer.h.
+ *      -j N    use N threads (see pass2Parallel in pass2.c).
+ *      --stats, --stats=text, --stats=json
+ *              print the assembler's counters and timers (see Stats.h)
+ *              to stderr when it is done, as text or as a JSON object.
  *
  * The optional filename indicates the input file; if it is provided,
  * process_arguments opens the file and returns it after also processing
@@ -25,13 +39,28 @@
  * debug_off, and debug_restore functions.
  */
 
+#include <stdlib.h>
+
 #include "process_arguments.h"
+#include "WordBuffer.h"
+#include "Stats.h"
 
 /* SAME is defined in disUtil.c and should be defined in other main files also. */
 
+/* Define the global OPTIONS variable. */
+ProgramOptions OPTIONS;
+
+/* Arguments accepted by process_arguments, for usage messages. */
+static const char * USAGE = "[-m] [-s] [-p] [-f bits|hex|le|be] [-j N] [--stats[=text|json]] [filename] [0|1]";
+
+/* Names of the output formats, in the order of OUTPUT_BITS, etc. */
+static const char * OUTPUT_FORMATS[] = { "bits", "hex", "le", "be" };
+
 FILE * process_arguments(int argc, char * argv[])
 {
     FILE * fptr;               /* file pointer */
+    int    i, j;               /* indices into the argument list */
+    int    nbrUsed;            /* number of arguments used by an option */
 
     /* Implementation notes:
      * The arguments are both optional and may be provided in either
@@ -55,6 +84,64 @@ FILE * process_arguments(int argc, char * argv[])
      *                         one argument, filename
      */
 
+    /* Process options first, "erasing" each one by shifting the
+     * arguments after it down, so that what is left is exactly the
+     * filename and debugging choice described below.
+     */
+    for ( i = 1; i < argc; )
+    {
+        if ( argv[i][0] != '-' || argv[i][1] == '\0' )
+        {
+            i++;
+            continue;
+        }
+
+        nbrUsed = 1;
+        if ( strcmp(argv[i], "-m") == SAME )
+            OPTIONS.mapInput = 1;
+        else if ( strcmp(argv[i], "-s") == SAME )
+            OPTIONS.onePass = 1;
+        else if ( strcmp(argv[i], "-p") == SAME )
+            OPTIONS.pipeline = 1;
+        else if ( strcmp(argv[i], "-f") == SAME && i + 1 < argc )
+        {
+            /* The format is the next argument. */
+            for ( j = 0; j < 4 && strcmp(argv[i + 1], OUTPUT_FORMATS[j]) != SAME; j++ )
+                ;
+            if ( j == 4 )
+            {
+                printError("Usage:  %s %s\n", argv[0], USAGE);
+                return NULL;
+            }
+            OPTIONS.outputFormat = j;
+            nbrUsed = 2;
+        }
+        else if ( strcmp(argv[i], "-j") == SAME && i + 1 < argc )
+        {
+            /* The number of threads is the next argument. */
+            OPTIONS.nbrThreads = atoi(argv[i + 1]);
+            if ( OPTIONS.nbrThreads < 1 )
+            {
+                printError("Usage:  %s %s\n", argv[0], USAGE);
+                return NULL;
+            }
+            nbrUsed = 2;
+        }
+        else if ( strcmp(argv[i], "--stats") == SAME || strcmp(argv[i], "--stats=text") == SAME )
+            OPTIONS.stats = STATS_TEXT;
+        else if ( strcmp(argv[i], "--stats=json") == SAME )
+            OPTIONS.stats = STATS_JSON;
+        else
+        {
+            printError("Usage:  %s %s\n", argv[0], USAGE);
+            return NULL;
+        }
+
+        for ( j = i; j < argc - nbrUsed; j++ )
+            argv[j] = argv[j + nbrUsed];
+        argc -= nbrUsed;
+    }
+
     /* Process debugging choice and then "erase" this argument by
      * shifting the filename into its place or just by reducing the
      * argument count, argc, whichever is appropriate (see above for details).
@@ -94,7 +181,7 @@ FILE * process_arguments(int argc, char * argv[])
      */
     if ( argc > 2 )
     {
-        printError("Usage:  %s [filename] [0|1]\n", argv[0]);
+        printError("Usage:  %s %s\n", argv[0], USAGE);
         return 0;
     }
 
@@ -11,6 +11,21 @@
 #include "printFuncs.h"
 #include "same.h"
 
+/* Options that may be given on the command line in addition to the
+ * filename and debugging choice.  process_arguments sets the fields of
+ * the global OPTIONS for the options it finds; every field is 0 otherwise.
+ */
+typedef struct {
+    int mapInput;       /* -m  map the input file into memory rather than reading it with fgets */
+    int onePass;        /* -s  assemble in a single pass, backpatching forward label references */
+    int pipeline;       /* -p  assemble in a single pass, with reading, tokenizing, and encoding on separate threads */
+    int outputFormat;   /* -f bits|hex|le|be  how to write the encoded words (OUTPUT_BITS, etc.; see WordBuffer.h) */
+    int nbrThreads;     /* -j N  number of threads to assemble with (0 if not given, which means 1) */
+    int stats;          /* --stats[=text|json]  print the counters and timers at the end (STATS_TEXT or STATS_JSON; see Stats.h) */
+} ProgramOptions;
+
+extern ProgramOptions OPTIONS;
+
 FILE * process_arguments(int argc, char * argv[]);
 
 #endif
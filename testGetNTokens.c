@@ -20,6 +20,8 @@
 #include "assembler.h"
 
 void runHardCodedTests ();
+void runScanTests (void);
+void runSpanTests (void);
 
 int main (int argc, char * argv[])
 {
@@ -101,6 +103,14 @@ int main (int argc, char * argv[])
     /* Run additional hard-coded tests, based on sample assembler testfile. */
     printf("\nAdditional Hard-coded Tests:\n\n");
     runHardCodedTests();
+
+    /* Run the same line through getTokenN with each version of the character scanning functions. */
+    printf("\nBlock Scanning Tests:\n\n");
+    runScanTests();
+
+    /* Run getNTokensN, which describes tokens in place rather than changing the string. */
+    printf("\nToken Span Tests:\n\n");
+    runSpanTests();
 }
 
 void runHardCodedTests ()
@@ -257,3 +267,78 @@ void runHardCodedTests ()
     printf("\n");
 
 }
+
+/* runScanTests splits a line that is longer than one block (with leading
+ * whitespace, tabs, and long tokens, so that tokens and whitespace cross
+ * block boundaries) using each version of the character scanning
+ * functions in turn (see CharScan.h).  Every version should print the
+ * same tokens, and the same comment.
+ */
+void runScanTests (void)
+{
+    const char * names[] = { "scalar", "sse2", "avx2" };
+    const char * line = "\t\t                   a_rather_long_label_name_for_testing:"
+                        "  beq\t$t0,\v$zero,another_rather_long_label_name  \r"
+                        "  #  comment: (not, tokens)";
+    const char * end;
+    const char * tokBegin, * tokEnd;
+    int level, selected;
+
+    for (level = SCAN_SCALAR; level <= SCAN_BEST; level++ )
+    {
+        selected = scanSelect (level);
+        if ( selected != level )
+            continue;       /* This machine does not have this version. */
+
+        printf ("%s:\t", names[selected]);
+        end = scanComment (line, line + strlen (line));
+        for ( tokBegin = line; tokBegin < end; tokBegin = tokEnd + 1 )
+        {
+            getTokenN (&tokBegin, &tokEnd, end);
+            if ( tokBegin == end )
+                break;
+            printf ("[%.*s] ", (int) (tokEnd - tokBegin), tokBegin);
+            if ( tokEnd == end )
+                break;
+        }
+        printf ("\n\tcomment: %s\n", end);
+    }
+    (void) scanSelect (SCAN_BEST);
+}
+
+/* runSpanTests reads operands with getNTokensN and prints each token
+ * span with its kind, then prints the line again to show that it has
+ * not been changed.  The last two lines should report errors.
+ */
+void runSpanTests (void)
+{
+    const char * kinds[] = { "register", "immediate", "memory", "label" };
+    const char * testStrings[] = {
+        "lw $a0, 0($t0)",
+        "addi $t0, $zero, -4",
+        "bne $t2, $zero, finish",
+        "j loop",
+        "add $t0, $t1",
+        "add $t0, $t1, $t2, $t3"
+    };
+    int expected[] = { 3, 3, 3, 1, 3, 3 };
+    TokenSpan results[3];
+    const char * line;
+    const char * operands;
+    int i, j;
+
+    for (i = 0; i < 6; i++ )
+    {
+        line = testStrings[i];
+        operands = strchr (line, ' ');
+        printf ("Line %d: %s\n\tExpect %d operands\n\tActual: ", i + 1, line, expected[i]);
+        if ( ! getNTokensN (operands, line + strlen (line), expected[i], results) )
+            printError ("Error on line %d: %.*s", i + 1,
+                        (int) results[0].length, results[0].begin);
+        else
+            for (j = 0; j < expected[i]; j++ )
+                printf ("%.*s (%s) ", (int) results[j].length, results[j].begin,
+                        kinds[results[j].kind]);
+        printf ("\n\tUnchanged: %s\n", line);
+    }
+}
@@ -20,6 +20,9 @@ const int SAME = 0;		/* useful for making strcmp readable */
 
 static int process_debug_choice(int argc, char * argv[]);
 static void testSearch(LabelTable * table, char * searchLabel);
+static void testSearchN(LabelTable * table, char * line, size_t length);
+static void testMany(LabelTable * table, int nbrToAdd);
+static void testBatch(LabelTable * table, int nbrAdded);
 
 int main(int argc, char * argv[])
 {
@@ -39,7 +42,10 @@ int main(int argc, char * argv[])
     LabelTable testTable1;      /* will be a table with static entries */
     LabelTable testTable2;      /* will be a table with dynamic entries */
 
-    /* Initialize testTable1 with a static array of a given size. */
+    /* Initialize testTable1 with a static array of a given size.
+     *    tableInit first so that it has no hash index and is searched linearly.
+     */
+    tableInit(&testTable1);
     testTable1.capacity = 5;
     testTable1.nbrLabels = 1;
     testTable1.entries = staticEntries;
@@ -59,6 +65,13 @@ int main(int argc, char * argv[])
 	/* Use testSearch to test findLabel */
 	testSearch(&testTable1, "Label1");
 
+	/* Add a label to the static label table, which has room for it but no hash index,
+	 *      and search for it ("Label2" should exist, at 1004).
+	 */
+	addLabel(&testTable1, "Label2", 1004);
+	printLabels(&testTable1);
+	testSearch(&testTable1, "Label2");
+
 	/* Basic boundary testing. */
 
 	/* Set nbrLabels to 0 and test. */
@@ -101,6 +114,9 @@ int main(int argc, char * argv[])
 	 */
 	printf("Capacity of the static label table is: %d\n", testTable1.capacity);
 
+	/* The static table's entries are not its own, but the name addLabel copied for "Label2" is. */
+	arenaFree(&testTable1.names);
+
 	printf("+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++\n");
 
     /* Initialize testTable2 as a dynamic (changeable size) table. */
@@ -134,6 +150,103 @@ int main(int argc, char * argv[])
 
 	/* Print the number of labels in the dynamic label table to the standard output. */
 	printf("Number of label entries in the dynamic label table: %d\n", testTable2.nbrLabels);
+
+	printf("+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++\n");
+
+	/* Test the hash index: a duplicate label should be reported and not added,
+	 *      and a missing label should not be found.
+	 */
+	printf("Adding duplicate DynamicLabel2 (expect an error message)...\n");
+	addLabel(&testTable2, "DynamicLabel2", 4000);
+	testSearch(&testTable2, "DynamicLabel2");
+	testSearch(&testTable2, "DynamicLabel0");
+
+	/* Test addLabelN and findLabelN with labels that are not null-terminated,
+	 *      as they would be if taken straight from a line of input.
+	 */
+	testSearchN(&testTable1, "Label3: add $t0, $t1, $t2", 6);
+	testSearchN(&testTable1, "Label; add $t0, $t1, $t2", 5);
+	addLabelN(&testTable2, "Token: lw $a0, 0($t0)", 5, 5000);
+	testSearchN(&testTable2, "Token: lw $a0, 0($t0)", 5);
+	testSearchN(&testTable2, "Tokens", 6);
+
+	/* Add enough labels to force several resizes (and index rebuilds), then look them all up. */
+	testMany(&testTable2, 1000);
+
+	/* Freeze the table into its single-probe layout and look the labels up again. */
+	printf("Freezing the dynamic label table: tableFreeze returned %d.\n", tableFreeze(&testTable2));
+	testSearch(&testTable2, "DynamicLabel4");
+	testSearchN(&testTable2, "Token: lw $a0, 0($t0)", 5);
+	testSearch(&testTable2, "DynamicLabel0");
+	testBatch(&testTable2, 1000);
+
+	/* Adding a label discards the frozen layout. */
+	addLabel(&testTable2, "AfterFreeze", 6000);
+	testSearch(&testTable2, "AfterFreeze");
+	testSearch(&testTable2, "DynamicLabel4");
+
+	/* Shrink the table to fit its labels; they should all still be found. */
+	printf("Shrinking the dynamic label table: tableShrinkToFit returned %d.\n", tableShrinkToFit(&testTable2));
+	printf("Capacity of the dynamic label table: %d (holding %d labels)\n",
+	       testTable2.capacity, testTable2.nbrLabels);
+	testSearch(&testTable2, "AfterFreeze");
+	testSearch(&testTable2, "DynamicLabel2");
+
+	/* Truncate the table to its first 3 labels; the dropped labels (and their names) are gone. */
+	printf("Resizing the dynamic label table to 3: tableResize returned %d.\n", tableResize(&testTable2, 3));
+	printLabels(&testTable2);
+	testSearch(&testTable2, "DynamicLabel3");
+	testSearch(&testTable2, "DynamicLabel4");
+
+	/* Free everything the dynamic table owns. */
+	tableDestroy(&testTable2);
+	printLabels(&testTable2);
+}
+
+/*
+ * testSearchN tests the findLabelN function, searching for the label
+ * made up of the first length characters of line.
+ *  @param  table   a pointer to the table through which to search
+ *  @param  line    a line whose first length characters are the label
+ *  @param  length  the number of characters in the label
+ */
+static void testSearchN(LabelTable * table, char * line, size_t length)
+{
+    printf("Looking for the first %d characters of \"%s\"...\n", (int) length, line);
+    printf("\tthe address is %d.\n", findLabelN(table, line, length));
+}
+
+/*
+ * testMany adds nbrToAdd generated labels to the table, then looks up
+ * every one of them, printing a one-line summary of how many were found
+ * at the expected address.
+ *  @param  table     a pointer to the table to add to
+ *  @param  nbrToAdd  the number of labels to add
+ */
+static void testMany(LabelTable * table, int nbrToAdd)
+{
+    char name[32];
+    int  i;
+    int  nbrFound = 0;
+
+    for ( i = 0; i < nbrToAdd; i++ )
+    {
+        sprintf(name, "Many%d", i);
+        addLabel(table, name, 4 * i);
+    }
+
+    for ( i = 0; i < nbrToAdd; i++ )
+    {
+        sprintf(name, "Many%d", i);
+        if ( findLabel(table, name) == 4 * i )
+            nbrFound++;
+    }
+
+    printf("Added %d generated labels; found %d at the expected address.\n",
+           nbrToAdd, nbrFound);
+
+    testBatch(table, nbrToAdd);
+    printf("Capacity of the dynamic label table: %d\n", table->capacity);
 }
 
 
@@ -166,3 +279,46 @@ static void testSearch(LabelTable * table, char * searchLabel)
 		printf("\tThe label you're looking for does not exist.\n");
 	}
 }
+
+/*
+ * testBatch tests the findLabelsBatch function by resolving, in one call,
+ * the labels added by testMany along with the same number of labels that
+ * are not in the table, printing a one-line summary of the results.
+ *  @param  table     a pointer to the table testMany added labels to
+ *  @param  nbrAdded  the number of labels testMany added
+ */
+static void testBatch(LabelTable * table, int nbrAdded)
+{
+    int          nbrNames = 2 * nbrAdded;
+    char *       storage = malloc(nbrNames * 32);
+    const char ** names = malloc(nbrNames * sizeof(char *));
+    size_t *     lengths = malloc(nbrNames * sizeof(size_t));
+    int *        addresses = malloc(nbrNames * sizeof(int));
+    int          i;
+    int          nbrCorrect = 0;
+    int          nbrFound;
+
+    if ( storage == NULL || names == NULL || lengths == NULL || addresses == NULL )
+    {
+        printError("Error: cannot allocate space in memory.\n");
+        free(storage); free(names); free(lengths); free(addresses);
+        return;
+    }
+
+    /* Interleave labels that are in the table with ones that are not. */
+    for ( i = 0; i < nbrNames; i++ )
+    {
+        lengths[i] = sprintf(storage + 32 * i, i % 2 == 0 ? "Many%d" : "Missing%d", i / 2);
+        names[i] = storage + 32 * i;
+    }
+
+    nbrFound = findLabelsBatch(table, names, lengths, nbrNames, addresses);
+    for ( i = 0; i < nbrNames; i++ )
+        if ( addresses[i] == (i % 2 == 0 ? 4 * (i / 2) : -1) )
+            nbrCorrect++;
+
+    printf("Batch of %d names: %d found, %d resolved correctly.\n",
+           nbrNames, nbrFound, nbrCorrect);
+
+    free(storage); free(names); free(lengths); free(addresses);
+}
@@ -0,0 +1,256 @@
+/*
+ * This is a driver to test onePass and its fixups (see Fixups.h) against
+ * the two-pass assembler (pass1Tokenize followed by pass2Tokens).
+ * Each test writes a small source to a temporary file, assembles it both
+ * ways, and checks that
+ *      - the two produce the same words, and
+ *      - each reports the number of errors the source should cause.
+ * The tests include:
+ *      - branches and jumps to labels defined later, with several fixups
+ *        waiting for the same label, mixed with references to labels that
+ *        are already defined;
+ *      - references to labels that are never defined, each of which should
+ *        be reported once, leaving its field zero;
+ *      - immediate values at and just past the ends of the signed and
+ *        unsigned immediate fields (see FIELDS in InstructionSet.c);
+ *      - a branch back to a label more than 32767 words before it, and a
+ *        forward branch to such a label, which onePass patches through a
+ *        fixup; both are out of range, and each leaves its field zero.
+ * There is also a test of the fixup functions on their own: several
+ * fixups waiting for one label are all patched when it is defined, and
+ * the ones waiting for a label that is never defined are reported.
+ * Each test prints what it checked and PASSED or FAILED.  The errors the
+ * sources cause are reported on stderr.
+ *
+ * USAGE:
+ *      testOnePass
+ */
+
+#include "assembler.h"
+
+const int SAME = 0;		/* Useful for making strcmp readable. */
+                                /* e.g., if (strcmp (str1, str2) == SAME) */
+
+/* A source to assemble: the lines in before, then nbrFiller copies of
+ *  FILLER, then the lines in after.
+ */
+typedef struct {
+    const char * what;
+    const char * before;
+    int          nbrFiller;
+    const char * after;
+    int          nbrErrors;     /* Errors the source should cause. */
+} TestSource;
+
+static const char * FILLER = "        add $t0, $t0, $t0\n";
+
+static const TestSource TESTS[] = {
+    { "forward references",
+      "main:   beq $t0, $t1, done\n"
+      "        bne $t0, $zero, done\n"
+      "        j done\n"
+      "        jal loop\n"
+      "loop:   addi $t0, $t0, -1\n"
+      "        bne $t0, $zero, loop\n"
+      "        blez $t1, later\n"
+      "        j main\n",
+      3,
+      "done:   bgtz $t0, loop\n"
+      "        beq $t0, $t0, done\n"
+      "later:  jal done\n"
+      "        jr $ra\n",
+      0 },
+    { "labels that are never defined",
+      "        beq $t0, $t1, nowhere\n"
+      "        j nowhere\n"
+      "        jal missing\n"
+      "here:   bne $t0, $zero, here\n",
+      2,
+      "        beq $t0, $t0, nowhere\n"
+      "        j here\n",
+      4 },
+    { "immediate ranges",
+      "        addi $t0, $t0, -32768\n"
+      "        slti $t0, $t0, 32767\n"
+      "        addi $t0, $t0, 32768\n"       /* Too big for a signed immediate. */
+      "        addiu $t0, $t0, 65535\n"      /* Likewise. */
+      "        andi $t0, $t0, 65535\n"
+      "        ori $t0, $t0, 0\n"
+      "        xori $t0, $t0, -1\n"          /* Unsigned immediates can't be negative. */
+      "        lui $t0, 0xffff\n"
+      "        lui $t0, 0x10000\n",          /* Too big for any immediate. */
+      0,
+      "",
+      4 },
+    { "out-of-range branches",
+      "top:    add $t0, $t0, $t0\n"
+      "        beq $t0, $t0, bottom\n",      /* Forward, through a fixup. */
+      40000,
+      "        bne $t0, $zero, top\n"        /* Backward. */
+      "bottom: beq $t0, $t0, near\n"
+      "near:   j top\n",
+      2 }
+};
+
+static int testFixups(void);
+static int testSource(const TestSource * test);
+static FILE * writeSource(const TestSource * test);
+static int assemble(FILE * fp, int useOnePass, WordBuffer * words);
+static int check(const char * what, int passed);
+
+int main(void)
+{
+    int nbrFailed = 0;
+    size_t i;
+
+    /* Every test source has errors on purpose; don't let them stop the test. */
+    ERROR_LIMIT = 0;
+
+    if ( ! testFixups() )
+        nbrFailed++;
+    for ( i = 0; i < sizeof(TESTS) / sizeof(TESTS[0]); i++ )
+        if ( ! testSource(&TESTS[i]) )
+            nbrFailed++;
+
+    return nbrFailed == 0 ? 0 : 1;
+}
+
+static int testFixups(void)
+  /* Records fixups by hand, resolves them, and checks the patched words.
+   * Returns 1 if every check passed; 0 otherwise.
+   */
+{
+    const char * line = "loop: j exit";
+    LabelRef   loop = { line, 4, LABEL_BRANCH };
+    LabelRef   loopJump = { line, 4, LABEL_JUMP };
+    LabelRef   exitRef = { line + 8, 4, LABEL_JUMP };
+    FixupList  fixups;
+    WordBuffer words;
+    int        i;
+    int        passed;
+
+    printf("Testing fixups on their own:\n");
+    (void) fflush(stdout);
+    fixupInit(&fixups);
+    wordsInit(&words);
+
+    /* Words 0, 1, and 3 wait for loop; word 2 waits for exit. */
+    for ( i = 0; i < 4; i++ )
+        (void) wordsAppend(&words, i == 2 ? 0x08000000u : 0x10000000u);
+    passed = check("fixups recorded",
+                   fixupAdd(&fixups, &loop, 0, 0, 1) && fixupAdd(&fixups, &loop, 1, 4, 2)
+                   && fixupAdd(&fixups, &exitRef, 2, 8, 3) && fixupAdd(&fixups, &loopJump, 3, 12, 4));
+    passed &= check("label nobody waits for patches nothing",
+                    fixupResolve(&fixups, "done", 4, 64, &words) == 0);
+    passed &= check("three words patched for loop",
+                    fixupResolve(&fixups, line, 4, 16, &words) == 3);
+    passed &= check("loop patched into each word",
+                    words.words[0] == 0x10000003u && words.words[1] == 0x10000002u
+                    && words.words[3] == 0x10000004u);
+    passed &= check("word waiting for exit untouched", words.words[2] == 0x08000000u);
+    passed &= check("loop defined again patches nothing",
+                    fixupResolve(&fixups, line, 4, 32, &words) == 0);
+    fprintf(stderr, "(expect one undefined label error, for exit on line 3)\n");
+    passed &= check("one fixup left unresolved", fixupReportUnresolved(&fixups) == 1);
+
+    wordsDestroy(&words);
+    fixupDestroy(&fixups);
+    return passed;
+}
+
+static int testSource(const TestSource * test)
+  /* Assembles test's source both ways and checks the results.
+   * Returns 1 if every check passed; 0 otherwise.
+   */
+{
+    FILE *     fp;
+    WordBuffer twoPass;
+    WordBuffer onePassWords;
+    int        twoPassErrors;
+    int        onePassErrors;
+    int        firstDiff;
+    int        passed;
+
+    printf("Testing %s:\n", test->what);
+    (void) fflush(stdout);          /* Before the errors the source causes. */
+    if ( (fp = writeSource(test)) == NULL )
+        return check("source written", 0);
+    fprintf(stderr, "(expect %d errors from each pass)\n", test->nbrErrors);
+
+    wordsInit(&twoPass);
+    wordsInit(&onePassWords);
+    twoPassErrors = assemble(fp, 0, &twoPass);
+    onePassErrors = assemble(fp, 1, &onePassWords);
+
+    /* Find the first word the two disagree on, if any. */
+    for ( firstDiff = 0; firstDiff < twoPass.nbrWords && firstDiff < onePassWords.nbrWords; firstDiff++ )
+        if ( twoPass.words[firstDiff] != onePassWords.words[firstDiff] )
+            break;
+    if ( firstDiff < twoPass.nbrWords && firstDiff < onePassWords.nbrWords )
+        printf("    word %d: two-pass %08x, one-pass %08x\n", firstDiff,
+               (unsigned) twoPass.words[firstDiff], (unsigned) onePassWords.words[firstDiff]);
+
+    passed = check("same number of words", twoPass.nbrWords == onePassWords.nbrWords);
+    passed &= check("same words", firstDiff == twoPass.nbrWords && firstDiff == onePassWords.nbrWords);
+    passed &= check("two-pass errors reported", twoPassErrors == test->nbrErrors);
+    passed &= check("one-pass errors reported", onePassErrors == test->nbrErrors);
+
+    wordsDestroy(&twoPass);
+    wordsDestroy(&onePassWords);
+    (void) fclose(fp);
+    return passed;
+}
+
+static FILE * writeSource(const TestSource * test)
+  /* Returns a temporary file holding test's source, or NULL if it could not be written. */
+{
+    FILE * fp;
+    int    i;
+
+    if ( (fp = tmpfile()) == NULL )
+        return NULL;
+    (void) fputs(test->before, fp);
+    for ( i = 0; i < test->nbrFiller; i++ )
+        (void) fputs(FILLER, fp);
+    (void) fputs(test->after, fp);
+    if ( ferror(fp) )
+    {
+        (void) fclose(fp);
+        return NULL;
+    }
+    return fp;
+}
+
+static int assemble(FILE * fp, int useOnePass, WordBuffer * words)
+  /* Assembles the source in fp into words, in one pass or two.
+   * Returns the number of errors reported while doing so.
+   */
+{
+    SourceFile  source;
+    TokenStream stream;
+    LabelTable  table;
+    int         errorsBefore = errorCount();
+
+    rewind(fp);
+    sourceOpen(&source, fp, 0);
+    streamInit(&stream);
+    if ( useOnePass )
+        table = onePass(&source, words);
+    else
+    {
+        table = pass1Tokenize(&source, &stream);
+        pass2Tokens(&stream, table, words);
+    }
+
+    streamDestroy(&stream);
+    tableDestroy(&table);
+    sourceClose(&source);
+    return errorCount() - errorsBefore;
+}
+
+static int check(const char * what, int passed)
+  /* Prints whether the check passed, and returns passed. */
+{
+    printf("    %-40s %s\n", what, passed ? "PASSED" : "FAILED");
+    return passed;
+}
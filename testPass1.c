@@ -12,11 +12,12 @@
  *              bne $t0, $zero, A_LABEL  # This instr. is at address 8
  *
  * USAGE:
- *      name [ filename ] [ 0|1 ]
+ *      name [ -m ] [ filename ] [ 0|1 ]
  * where "name" is the name of the executable,
- *       "filename" is an optional file containing the input to read, and
+ *       "filename" is an optional file containing the input to read,
  *       " 0" or "1" specifies that debugging should be turned off or on, respectively,
- *            regardless of any calls to debug_on, debug_off, or debug_restore in the program.
+ *            regardless of any calls to debug_on, debug_off, or debug_restore in the program, and
+ *       "-m" maps the input file into memory rather than reading it line by line.
  * Both arguments are optional; if both are present they may appear in either order.
  * If no filename is provided, the program reads its input from stdin.
  * If no debugging choice is provided, the program prints debugging messages, or not, depending on indications in the code.
@@ -56,6 +57,7 @@ const int SAME = 0;		/* Useful for making strcmp readable. */
 int main (int argc, char * argv[])
 {
     FILE * fptr;               /* File pointer. */
+    SourceFile source;         /* Lines of the input, mapped (-m) or read through fptr. */
     LabelTable table;
 
     /* Process command-line arguments (if any)
@@ -73,7 +75,8 @@ int main (int argc, char * argv[])
     debug_on();  /* Turn debugging on for testing purposes. */
 
     /* Call pass1 to generate the label table. */
-    table = pass1 (fptr);
+    sourceOpen(&source, fptr, OPTIONS.mapInput);
+    table = pass1Source (&source);
 
     /* Print the label table if debugging is turned on. */
     if ( debug_is_on() )
@@ -86,6 +89,8 @@ int main (int argc, char * argv[])
      *      pass2(fptr, table);
      */
 
+    tableDestroy(&table);
+    sourceClose(&source);
     (void) fclose(fptr);
     return 0;
 }
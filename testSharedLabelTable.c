@@ -0,0 +1,223 @@
+/*
+ * This is a driver to test the shared (thread-safe) label table functions.
+ * It includes the following tests:
+ *      - adding and finding labels from one thread, including a duplicate
+ *        label, a label that is not in the table, and labels given by
+ *        beginning and length (not null-terminated);
+ *      - a stress test in which several writer threads add labels at the
+ *        same time (each its own labels, plus a set of labels that every
+ *        writer tries to add), growing the table many times over, while
+ *        reader threads look up labels the whole time.  Every lookup that
+ *        finds a label must find its right address; afterwards every label
+ *        must be in the table exactly once.
+ * Each test prints what it checked and PASSED or FAILED.  The labels every
+ * writer tries to add are reported as duplicates (on stderr) by all but
+ * the writer that added each one first.
+ *
+ * USAGE:
+ *      testSharedLabelTable [ writers [ labels ] ]
+ * where writers is the number of writer threads (default: 8; there are as
+ *       many reader threads), and
+ *       labels is the number of labels each writer adds (default: 20000).
+ */
+
+#include "assembler.h"
+
+const int SAME = 0;		/* Useful for making strcmp readable. */
+                                /* e.g., if (strcmp (str1, str2) == SAME) */
+
+/* Number of labels every writer tries to add. */
+#define NBR_COMMON 8
+
+/* What each stress-test thread does. */
+typedef struct {
+    SharedLabelTable * table;
+    int     threadNbr;
+    int     nbrWriters;
+    int     nbrLabels;          /* Number of labels each writer adds. */
+    atomic_int * writersDone;   /* Readers stop once every writer is done. */
+    long    nbrFound;           /* Readers: lookups that found their label. */
+    long    nbrWrong;           /* Readers: lookups that found the wrong address. */
+    int     status;             /* Writers: 0 if an add failed. */
+} StressThread;
+
+static void testBasics(void);
+static int stressTest(int nbrWriters, int nbrLabels);
+static void * writer(void * thread);
+static void * reader(void * thread);
+static int labelAddress(int writerNbr, int labelNbr);
+static void check(const char * what, int passed);
+
+int main(int argc, char * argv[])
+{
+    int nbrWriters = argc > 1 ? atoi(argv[1]) : 8;
+    int nbrLabels = argc > 2 ? atoi(argv[2]) : 20000;
+
+    /* Duplicates are expected; don't let them stop the test. */
+    ERROR_LIMIT = 0;
+
+    testBasics();
+    return stressTest(nbrWriters, nbrLabels) ? 0 : 1;
+}
+
+static void testBasics(void)
+{
+    SharedLabelTable table;
+    const char * line = "loop: add $t0, $t1, $t2";
+
+    printf("Testing one thread:\n");
+    check("table initialized", sharedTableInit(&table) == 1 && sharedNbrLabels(&table) == 0);
+    check("add main", sharedAddLabel(&table, "main", 0) == 1);
+    check("add loop by length", sharedAddLabelN(&table, line, 4, 8) == 1);
+    check("find main", sharedFindLabel(&table, "main") == 0);
+    check("find loop", sharedFindLabel(&table, "loop") == 8);
+    check("find loop by length", sharedFindLabelN(&table, line, 4) == 8);
+    check("prefix lo is not a label", sharedFindLabelN(&table, line, 2) == -1);
+    check("missing is not a label", sharedFindLabel(&table, "missing") == -1);
+    fprintf(stderr, "(expect one duplicate label error)\n");
+    check("duplicate main is not fatal", sharedAddLabel(&table, "main", 40) == 1);
+    check("duplicate main keeps first address", sharedFindLabel(&table, "main") == 0);
+    check("two labels", sharedNbrLabels(&table) == 2);
+    fprintf(stderr, "(expect two NULL table errors)\n");
+    check("NULL table add fails", sharedAddLabel(NULL, "main", 0) == 0);
+    check("NULL table find fails", sharedFindLabel(NULL, "main") == -1);
+    sharedTableDestroy(&table);
+}
+
+static int stressTest(int nbrWriters, int nbrLabels)
+{
+    SharedLabelTable table;
+    StressThread * threads;
+    pthread_t *    ids;
+    atomic_int     writersDone;
+    char           name[32];
+    int            i, j, address;
+    int            passed = 1;
+    int            allFound = 1;
+    long           nbrFound = 0, nbrWrong = 0;
+
+    printf("Stress test: %d writers adding %d labels each, %d readers:\n",
+           nbrWriters, nbrLabels, nbrWriters);
+    if ( sharedTableInit(&table) == 0 ||
+         (threads = malloc(2 * nbrWriters * sizeof(StressThread))) == NULL ||
+         (ids = malloc(2 * nbrWriters * sizeof(pthread_t))) == NULL )
+    {
+        check("memory for the test", 0);
+        return 0;
+    }
+    atomic_init(&writersDone, 0);
+
+    /* Threads 0..nbrWriters-1 write; the rest read. */
+    fprintf(stderr, "(expect %d duplicate label errors)\n", NBR_COMMON * (nbrWriters - 1));
+    for ( i = 0; i < 2 * nbrWriters; i++ )
+    {
+        threads[i].table = &table;
+        threads[i].threadNbr = i;
+        threads[i].nbrWriters = nbrWriters;
+        threads[i].nbrLabels = nbrLabels;
+        threads[i].writersDone = &writersDone;
+        threads[i].nbrFound = 0;
+        threads[i].nbrWrong = 0;
+        threads[i].status = 1;
+        if ( pthread_create(&ids[i], NULL, i < nbrWriters ? writer : reader, &threads[i]) != 0 )
+        {
+            check("threads started", 0);
+            return 0;
+        }
+    }
+    for ( i = 0; i < 2 * nbrWriters; i++ )
+    {
+        (void) pthread_join(ids[i], NULL);
+        if ( i < nbrWriters )
+            passed &= threads[i].status;
+        nbrFound += threads[i].nbrFound;
+        nbrWrong += threads[i].nbrWrong;
+    }
+    check("every add succeeded", passed);
+
+    /* Every writer's labels are there, with their own addresses. */
+    for ( i = 0; i < nbrWriters; i++ )
+        for ( j = 0; j < nbrLabels; j++ )
+        {
+            (void) sprintf(name, "w%d_label%d", i, j);
+            allFound &= sharedFindLabel(&table, name) == labelAddress(i, j);
+        }
+    check("every label found at its address", allFound);
+
+    /* Each common label was added by exactly one of the writers. */
+    allFound = 1;
+    for ( j = 0; j < NBR_COMMON; j++ )
+    {
+        (void) sprintf(name, "common%d", j);
+        address = sharedFindLabel(&table, name);
+        allFound &= address >= 0 && address % 4 == 0 && address / 4 < nbrWriters;
+    }
+    check("every common label added once", allFound);
+    check("number of labels", sharedNbrLabels(&table) == nbrWriters * nbrLabels + NBR_COMMON);
+    printf("    readers found %ld labels while they were being added\n", nbrFound);
+    check("no reader found a wrong address", nbrWrong == 0);
+
+    sharedTableDestroy(&table);
+    free(threads);
+    free(ids);
+    return passed && allFound && nbrWrong == 0;
+}
+
+static void * writer(void * arg)
+  /* Adds this writer's labels, and tries to add the common labels part way through. */
+{
+    StressThread * thread = arg;
+    char  name[32];
+    int   j, k;
+
+    for ( j = 0; j < thread->nbrLabels; j++ )
+    {
+        (void) sprintf(name, "w%d_label%d", thread->threadNbr, j);
+        thread->status &= sharedAddLabel(thread->table, name, labelAddress(thread->threadNbr, j));
+        if ( j == thread->nbrLabels / 2 )
+            for ( k = 0; k < NBR_COMMON; k++ )
+            {
+                (void) sprintf(name, "common%d", k);
+                thread->status &= sharedAddLabel(thread->table, name, 4 * thread->threadNbr);
+            }
+    }
+
+    (void) atomic_fetch_add(thread->writersDone, 1);
+    return NULL;
+}
+
+static void * reader(void * arg)
+  /* Looks up the writers' labels until every writer is done, checking each address found. */
+{
+    StressThread * thread = arg;
+    char     name[32];
+    unsigned random = (unsigned) thread->threadNbr * 2654435761u + 1;
+    int      writerNbr, labelNbr, address;
+
+    while ( atomic_load(thread->writersDone) < thread->nbrWriters )
+    {
+        random = random * 1103515245u + 12345u;
+        writerNbr = (random >> 8) % thread->nbrWriters;
+        labelNbr = (random >> 12) % thread->nbrLabels;
+        (void) sprintf(name, "w%d_label%d", writerNbr, labelNbr);
+
+        if ( (address = sharedFindLabel(thread->table, name)) == -1 )
+            continue;               /* Not added yet. */
+        thread->nbrFound++;
+        if ( address != labelAddress(writerNbr, labelNbr) )
+            thread->nbrWrong++;
+    }
+
+    return NULL;
+}
+
+static int labelAddress(int writerNbr, int labelNbr)
+  /* Returns the address writer writerNbr gives its label number labelNbr. */
+{
+    return (writerNbr * 1000000 + labelNbr) * 4;
+}
+
+static void check(const char * what, int passed)
+{
+    printf("    %-40s %s\n", what, passed ? "PASSED" : "FAILED");
+}